@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Crc32c.h"
+#include <cstring>
+
+#if defined( __x86_64__ ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+  #include <nmmintrin.h>
+  #define NYX_CRC32C_SSE42
+  #define NYX_TARGET_SSE42 __attribute__( ( target( "sse4.2" ) ) )
+#elif defined( _M_X64 ) && defined( _MSC_VER )
+  #include <nmmintrin.h>
+  #include <intrin.h>
+  #define NYX_CRC32C_SSE42
+  #define NYX_TARGET_SSE42
+#endif
+
+namespace nyx
+{
+  namespace
+  {
+    /** Structure containing the lookup tables of the slice-by-8 CRC.
+     */
+    struct Tables
+    {
+      unsigned table[ 8 ][ 256 ] ; ///< The table of each of the eight bytes handled at a time.
+
+      /** Default constructor. Generates the tables.
+       */
+      Tables() ;
+    };
+
+    Tables::Tables()
+    {
+      for( unsigned index = 0; index < 256; index++ )
+      {
+        unsigned crc = index ;
+
+        for( unsigned bit = 0; bit < 8; bit++ ) crc = ( crc >> 1 ) ^ ( 0x82F63B78u & ( 0u - ( crc & 1 ) ) ) ;
+        this->table[ 0 ][ index ] = crc ;
+      }
+
+      for( unsigned index = 0; index < 256; index++ )
+      {
+        for( unsigned slice = 1; slice < 8; slice++ )
+        {
+          const unsigned prev = this->table[ slice - 1 ][ index ] ;
+
+          this->table[ slice ][ index ] = ( prev >> 8 ) ^ this->table[ 0 ][ prev & 0xFF ] ;
+        }
+      }
+    }
+
+    /** Method to compute a CRC32C with the lookup tables.
+     * @param bytes The first byte to compute the CRC of.
+     * @param size The amount of bytes.
+     * @param crc The running, inverted CRC.
+     * @return The running, inverted CRC after the bytes.
+     */
+    unsigned crcTables( const unsigned char* bytes, unsigned long long size, unsigned crc )
+    {
+      static const Tables tables ;
+
+      const auto& table = tables.table ;
+      unsigned    lo    ;
+      unsigned    hi    ;
+
+      while( size >= 8 )
+      {
+        memcpy( &lo, bytes    , sizeof( unsigned ) ) ;
+        memcpy( &hi, bytes + 4, sizeof( unsigned ) ) ;
+        lo ^= crc ;
+
+        crc = table[ 7 ][ lo & 0xFF ] ^ table[ 6 ][ ( lo >> 8 ) & 0xFF ] ^ table[ 5 ][ ( lo >> 16 ) & 0xFF ] ^ table[ 4 ][ lo >> 24 ] ^
+              table[ 3 ][ hi & 0xFF ] ^ table[ 2 ][ ( hi >> 8 ) & 0xFF ] ^ table[ 1 ][ ( hi >> 16 ) & 0xFF ] ^ table[ 0 ][ hi >> 24 ] ;
+
+        bytes += 8 ;
+        size  -= 8 ;
+      }
+
+      while( size-- ) crc = ( crc >> 8 ) ^ table[ 0 ][ ( crc ^ *bytes++ ) & 0xFF ] ;
+
+      return crc ;
+    }
+
+  #ifdef NYX_CRC32C_SSE42
+    /** Method to compute a CRC32C with the SSE4.2 crc32 instruction.
+     * @param bytes The first byte to compute the CRC of.
+     * @param size The amount of bytes.
+     * @param crc The running, inverted CRC.
+     * @return The running, inverted CRC after the bytes.
+     */
+    NYX_TARGET_SSE42 unsigned crcSse42( const unsigned char* bytes, unsigned long long size, unsigned crc )
+    {
+      unsigned long long wide = crc ;
+      unsigned long long word     ;
+
+      while( size >= 8 )
+      {
+        memcpy( &word, bytes, sizeof( word ) ) ;
+        wide   = _mm_crc32_u64( wide, word ) ;
+        bytes += 8 ;
+        size  -= 8 ;
+      }
+
+      crc = static_cast<unsigned>( wide ) ;
+      while( size-- ) crc = _mm_crc32_u8( crc, *bytes++ ) ;
+
+      return crc ;
+    }
+
+    /** Method to check whether the processor has the SSE4.2 crc32 instruction.
+     * @return Whether or not crcSse42() can be used.
+     */
+    bool hasSse42()
+    {
+    #if defined( _MSC_VER )
+      int info[ 4 ] ;
+
+      __cpuid( info, 1 ) ;
+      return ( info[ 2 ] & ( 1 << 20 ) ) != 0 ;
+    #else
+      return __builtin_cpu_supports( "sse4.2" ) ;
+    #endif
+    }
+  #endif
+  }
+
+  unsigned crc32c( const unsigned char* bytes, unsigned long long size, unsigned crc )
+  {
+  #ifdef NYX_CRC32C_SSE42
+    static const bool sse42 = hasSse42() ;
+
+    if( sse42 ) return ~crcSse42( bytes, size, ~crc ) ;
+  #endif
+
+    return ~crcTables( bytes, size, ~crc ) ;
+  }
+}
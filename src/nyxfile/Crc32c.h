@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/* CRC32C ( Castagnoli, reflected polynomial 0x82F63B78 ), as used to check the sections of a .nyx file.
+ *
+ * On x86-64 processors with SSE4.2 the crc32 instruction is used, eight bytes at a time. Everywhere else
+ * the bytes are run through eight lookup tables, eight bytes at a time ( slice-by-8 ).
+ */
+namespace nyx
+{
+  /** Method to compute the CRC32C of a range of bytes.
+   * @param bytes The first byte to compute the CRC of.
+   * @param size The amount of bytes.
+   * @param crc The CRC of the bytes preceding these ones to continue from, or 0 to start a new one.
+   * @return The CRC32C of the bytes.
+   */
+  unsigned crc32c( const unsigned char* bytes, unsigned long long size, unsigned crc = 0 ) ;
+}
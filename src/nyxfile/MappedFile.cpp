@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFile.h"
+#include <vector>
+#include <fstream>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#elif defined( _WIN32 )
+  #define WIN32_LEAN_AND_MEAN
+  #include <windows.h>
+#endif
+
+namespace nyx
+{
+  /** Structure containing the data of a mapped file.
+   */
+  struct MappedFileData
+  {
+    const unsigned char*       bytes   = nullptr ; ///< The start of the mapped bytes.
+    unsigned long long         size    = 0       ; ///< The amount of mapped bytes.
+    std::vector<unsigned char> fallback          ; ///< Storage used when the platform has no way of mapping files.
+
+  #if !defined( __unix__ ) && !defined( __APPLE__ ) && defined( _WIN32 )
+    HANDLE file    = INVALID_HANDLE_VALUE ; ///< The handle to the opened file.
+    HANDLE mapping = nullptr              ; ///< The handle to the file's mapping object.
+  #endif
+  };
+
+  MappedFile::MappedFile()
+  {
+    this->mapped_data = new MappedFileData() ;
+  }
+
+  MappedFile::~MappedFile()
+  {
+    this->unmap() ;
+    delete this->mapped_data ;
+  }
+
+  bool MappedFile::map( const char* path )
+  {
+    this->unmap() ;
+
+  #if defined( __unix__ ) || defined( __APPLE__ )
+    struct stat info ;
+    void*       ptr  ;
+    int         fd   ;
+
+    fd = ::open( path, O_RDONLY ) ;
+    if( fd < 0 ) return false ;
+
+    if( ::fstat( fd, &info ) != 0 )
+    {
+      ::close( fd ) ;
+      return false ;
+    }
+
+    // Mapping zero bytes is an error, but an empty file is still a valid (empty) mapping.
+    if( info.st_size > 0 )
+    {
+      ptr = ::mmap( nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 ) ;
+      if( ptr == MAP_FAILED )
+      {
+        ::close( fd ) ;
+        return false ;
+      }
+
+      data().bytes = static_cast<const unsigned char*>( ptr ) ;
+      data().size  = info.st_size                            ;
+    }
+
+    // The mapping keeps its own reference to the file.
+    ::close( fd ) ;
+    return true ;
+  #elif defined( _WIN32 )
+    LARGE_INTEGER size ;
+    void*         ptr  ;
+
+    data().file = ::CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr ) ;
+    if( data().file == INVALID_HANDLE_VALUE ) return false ;
+
+    if( !::GetFileSizeEx( data().file, &size ) )
+    {
+      this->unmap() ;
+      return false ;
+    }
+
+    if( size.QuadPart > 0 )
+    {
+      data().mapping = ::CreateFileMappingA( data().file, nullptr, PAGE_READONLY, 0, 0, nullptr ) ;
+      ptr            = data().mapping ? ::MapViewOfFile( data().mapping, FILE_MAP_READ, 0, 0, 0 ) : nullptr ;
+      if( !ptr )
+      {
+        this->unmap() ;
+        return false ;
+      }
+
+      data().bytes = static_cast<const unsigned char*>( ptr ) ;
+      data().size  = size.QuadPart                           ;
+    }
+    return true ;
+  #else
+    std::ifstream stream ;
+
+    stream.open( path, std::ios::binary ) ;
+    if( !stream ) return false ;
+
+    data().fallback.assign( ( std::istreambuf_iterator<char>( stream ) ), std::istreambuf_iterator<char>() ) ;
+    data().bytes = data().fallback.data() ;
+    data().size  = data().fallback.size() ;
+    return true ;
+  #endif
+  }
+
+  void MappedFile::unmap()
+  {
+  #if defined( __unix__ ) || defined( __APPLE__ )
+    if( data().bytes && data().fallback.empty() )
+    {
+      ::munmap( const_cast<unsigned char*>( data().bytes ), data().size ) ;
+    }
+  #elif defined( _WIN32 )
+    if( data().bytes && data().fallback.empty() ) ::UnmapViewOfFile( data().bytes ) ;
+    if( data().mapping                          ) ::CloseHandle    ( data().mapping ) ;
+    if( data().file != INVALID_HANDLE_VALUE     ) ::CloseHandle    ( data().file    ) ;
+
+    data().mapping = nullptr              ;
+    data().file    = INVALID_HANDLE_VALUE ;
+  #endif
+
+    data().fallback.clear() ;
+    data().bytes = nullptr ;
+    data().size  = 0       ;
+  }
+
+  const unsigned char* MappedFile::bytes() const
+  {
+    return data().bytes ;
+  }
+
+  unsigned long long MappedFile::size() const
+  {
+    return data().size ;
+  }
+
+  MappedFileData& MappedFile::data()
+  {
+    return *this->mapped_data ;
+  }
+
+  const MappedFileData& MappedFile::data() const
+  {
+    return *this->mapped_data ;
+  }
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+namespace nyx
+{
+  /** Class to manage a read-only view of a file's bytes mapped into memory.
+   * Anything pointing into the mapping is valid only as long as this object lives.
+   */
+  class MappedFile
+  {
+    public:
+
+      /** Default constructor.
+       */
+      MappedFile() ;
+
+      /** Default deconstructor. Releases the mapping, if any.
+       */
+      ~MappedFile() ;
+
+      /** Method to map the file at the input path into memory.
+       * @param path The C-string path of the file on the filesystem to map.
+       * @return Whether or not the file was able to be mapped.
+       */
+      bool map( const char* path ) ;
+
+      /** Method to release the current mapping, if any.
+       */
+      void unmap() ;
+
+      /** Method to retrieve the first byte of the mapping.
+       * @return Pointer to the start of the mapped bytes.
+       */
+      const unsigned char* bytes() const ;
+
+      /** Method to retrieve the amount of bytes in the mapping.
+       * @return The size in bytes of the mapping.
+       */
+      unsigned long long size() const ;
+
+    private:
+
+      /** Mappings are unique, and so cannot be copied.
+       */
+      MappedFile( const MappedFile& orig ) ;
+      MappedFile& operator=( const MappedFile& orig ) ;
+
+      /** Forward declared structure containing this object's data.
+       */
+      struct MappedFileData* mapped_data ;
+
+      /** Method to retrieve a reference to this object's internal data structure.
+       * @return Reference to this object's internal data structure.
+       */
+      MappedFileData& data() ;
+
+      /** Method to retrieve a const-reference to this object's internal data structure.
+       * @return Const-reference to this object's internal data structure.
+       */
+      const MappedFileData& data() const ;
+  };
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NyxArchive.h"
+#include "NyxFile.h"
+#include "NyxFormat.h"
+#include <string.h>
+
+namespace nyx
+{
+  /** Structure containing the data of an archive.
+   */
+  struct NyxArchiveData
+  {
+    NyxFile              file                  ; ///< The file holding the archive's mapping.
+    const unsigned char* bytes       = nullptr ; ///< The first byte of the archive.
+    unsigned long long   size        = 0       ; ///< The amount of bytes in the archive.
+    const char*          names       = nullptr ; ///< The names of the archive's entries.
+    unsigned             names_size  = 0       ; ///< The size in bytes of the names.
+    unsigned             num_entries = 0       ; ///< The amount of entries in the archive's directory.
+
+    /** Method to retrieve an entry of the archive's directory.
+     * @param index The index of the entry.
+     * @return The entry at that index.
+     */
+    NyxArchiveEntry entry( unsigned index ) const ;
+
+    /** Method to retrieve the name of an entry.
+     * @param entry The entry to retrieve the name of.
+     * @return The C-string name of the entry.
+     */
+    const char* name( const NyxArchiveEntry& entry ) const ;
+
+    /** Method to check that the archive's directory only refers to bytes inside of the archive.
+     * @return Whether or not every entry of the directory is valid.
+     */
+    bool validate() const ;
+  };
+
+  NyxArchiveEntry NyxArchiveData::entry( unsigned index ) const
+  {
+    NyxArchiveEntry out ;
+
+    memcpy( &out, this->bytes + sizeof( NyxArchiveHeader ) + index * sizeof( NyxArchiveEntry ), sizeof( NyxArchiveEntry ) ) ;
+    return out ;
+  }
+
+  const char* NyxArchiveData::name( const NyxArchiveEntry& entry ) const
+  {
+    return this->names + entry.name ;
+  }
+
+  bool NyxArchiveData::validate() const
+  {
+    for( unsigned index = 0; index < this->num_entries; index++ )
+    {
+      const NyxArchiveEntry entry = this->entry( index ) ;
+
+      if( entry.name >= this->names_size                                            ) return false ;
+      if( static_cast<unsigned long long>( entry.offset ) + entry.size > this->size ) return false ;
+    }
+
+    return true ;
+  }
+
+  NyxArchive::NyxArchive()
+  {
+    this->archive_data = new NyxArchiveData() ;
+  }
+
+  NyxArchive::~NyxArchive()
+  {
+    delete this->archive_data ;
+  }
+
+  bool NyxArchive::load( const char* path )
+  {
+    NyxArchiveHeader header ;
+
+    data().bytes       = nullptr ;
+    data().size        = 0       ;
+    data().names       = nullptr ;
+    data().names_size  = 0       ;
+    data().num_entries = 0       ;
+
+    if( !data().file.map( path ) ) return false ;
+
+    data().bytes = data().file.mapping( data().size ) ;
+    if( data().size < sizeof( NyxArchiveHeader ) ) return false ;
+
+    memcpy( &header, data().bytes, sizeof( NyxArchiveHeader ) ) ;
+
+    if( header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION ) return false ;
+
+    // The directory & names have to fit, and the names have to end in a terminator so every name inside of them does.
+    if( sizeof( NyxArchiveHeader ) + static_cast<unsigned long long>( header.num_entries ) * sizeof( NyxArchiveEntry ) > data().size ) return false ;
+    if( static_cast<unsigned long long>( header.names_offset ) + header.names_size > data().size                                   ) return false ;
+    if( header.names_size == 0 || data().bytes[ header.names_offset + header.names_size - 1 ] != '\0'                               ) return false ;
+
+    data().names       = reinterpret_cast<const char*>( data().bytes + header.names_offset ) ;
+    data().names_size  = header.names_size                                                   ;
+    data().num_entries = header.num_entries                                                  ;
+
+    if( !data().validate() )
+    {
+      data().num_entries = 0 ;
+      return false ;
+    }
+
+    return true ;
+  }
+
+  bool NyxArchive::find( const char* name, NyxFile& file ) const
+  {
+    unsigned low  = 0                  ;
+    unsigned high = data().num_entries ;
+
+    // The directory is sorted by name, so it can be binary searched.
+    while( low < high )
+    {
+      const unsigned        middle = low + ( high - low ) / 2           ;
+      const NyxArchiveEntry entry  = data().entry( middle )              ;
+      const int             order  = strcmp( data().name( entry ), name ) ;
+
+      if( order == 0 )
+      {
+        // The file's SPIRV is shared, and lives past its end.
+        return file.view( data().file, data().bytes + entry.offset, data().size - entry.offset ) ;
+      }
+
+      if( order < 0 ) low  = middle + 1 ;
+      else            high = middle     ;
+    }
+
+    return false ;
+  }
+
+  const char* NyxArchive::name( unsigned index ) const
+  {
+    return index < data().num_entries ? data().name( data().entry( index ) ) : "" ;
+  }
+
+  unsigned NyxArchive::size() const
+  {
+    return data().num_entries ;
+  }
+
+  NyxArchiveData& NyxArchive::data()
+  {
+    return *this->archive_data ;
+  }
+
+  const NyxArchiveData& NyxArchive::data() const
+  {
+    return *this->archive_data ;
+  }
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+namespace nyx
+{
+  class NyxFile ;
+
+  /** Class to read many .nyx files packed into a single .nyxa archive.
+   * The whole archive is memory mapped once, and every .nyx file is read in place out of that mapping.
+   */
+  class NyxArchive
+  {
+    public:
+
+      /** Default constructor.
+       */
+      NyxArchive() ;
+
+      /** Default deconstructor.
+       * Files found in this object keep the mapping alive on their own, and stay valid after this object is gone.
+       */
+      ~NyxArchive() ;
+
+      /** Method to load the .nyxa archive at the input path.
+       * @param path The C-string path of the archive on the filesystem to load.
+       * @return Whether or not the archive was able to be loaded.
+       */
+      bool load( const char* path ) ;
+
+      /** Method to find a .nyx file in this archive by its name.
+       * The file is viewed in place, and shares this object's mapping instead of copying any of it.
+       * @param name The C-string name the file was archived with.
+       * @param file The object to load the file into.
+       * @return Whether or not this archive contains a valid .nyx file with that name.
+       */
+      bool find( const char* name, NyxFile& file ) const ;
+
+      /** Method to retrieve the name of the file at the specified index.
+       * Files are ordered by name.
+       * @param index The index of the file to retrieve the name of.
+       * @return The C-string name of the file, or an empty string if the index is out of range.
+       */
+      const char* name( unsigned index ) const ;
+
+      /** Method to retrieve the number of files in this archive.
+       * @return The number of files in this archive.
+       */
+      unsigned size() const ;
+
+    private:
+
+      /** Archives own a mapping, and so cannot be copied.
+       */
+      NyxArchive( const NyxArchive& orig ) ;
+      NyxArchive& operator=( const NyxArchive& orig ) ;
+
+      /** Forward declared structure containing this object's data.
+       */
+      struct NyxArchiveData* archive_data ;
+
+      /** Method to retrieve a reference to this object's internal data structure.
+       * @return Reference to this object's internal data structure.
+       */
+      NyxArchiveData& data() ;
+
+      /** Method to retrieve a const-reference to this object's internal data structure.
+       * @return Const-reference to this object's internal data structure.
+       */
+      const NyxArchiveData& data() const ;
+  };
+}
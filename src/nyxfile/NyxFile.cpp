@@ -17,30 +17,69 @@
 
 
 #include "NyxFile.h"
+#include "NyxFileBuilder.h"
+#include "MappedFile.h"
+#include "NyxFormat.h"
+#include "SpirvCodec.h"
 #include <string>
-#include <sstream>
-#include <fstream>
-#include <ostream>
-#include <istream>
 #include <iostream>
 #include <vector>
 #include <cerrno>
 #include <memory>
 #include <algorithm>
 #include <ctype.h>
+#include <utility>
+#include <deque>
+#include <mutex>
+#include <atomic>
 #include <map>
 #include <limits.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 
 namespace nyx
 {
-  struct Shader ;
-  typedef std::map<nyx::ShaderStage, Shader> ShaderMap ;
+  // The writer has its own structures by these names, so these are kept internal to not clash with them when linked together.
+  namespace
+  {
+    struct Uniform   ;
+    struct Attribute ;
+    struct Guard     ;
+    struct Strings   ;
+    struct NameTable ;
+    struct Shader    ;
+    struct Cursor    ;
+  }
+
+  /** The amount of shader stages a file can contain, one for each ShaderStage.
+   */
+  constexpr unsigned NUM_STAGES = ShaderStage::Compute + 1 ;
 
-  const unsigned long long MAGIC = 0x555755200d0a ;
+  /** The least amount of bytes an attribute or a uniform takes up in a file, being four values of which strings are the smallest.
+   */
+  constexpr unsigned MIN_RECORD_SIZE = 4 * sizeof( unsigned ) ;
 
   static inline unsigned sizeFromType( std::string type_name ) ;
 
+  /** Method to read a list of attributes.
+   * @param cursor The cursor to read from.
+   * @param strings The strings to resolve the attributes' names with.
+   * @param count The amount of attributes to read.
+   * @param list The list to append the attributes to.
+   * @return Whether or not the cursor has enough bytes left to hold that many attributes. If not, nothing is read.
+   */
+  static bool readAttributes( Cursor& cursor, Strings& strings, unsigned count, std::vector<Attribute>& list ) ;
+
+  /** Method to read the uniforms of a shader stage.
+   * @param cursor The cursor to read from.
+   * @param strings The strings to resolve the uniforms' names with.
+   * @param count The amount of uniforms to read.
+   * @param list The list to append the uniforms to.
+   * @return Whether or not the cursor has enough bytes left to hold that many uniforms. If not, nothing is read.
+   */
+  static bool readUniforms( Cursor& cursor, Strings& strings, unsigned count, std::vector<Uniform>& list ) ;
+
   unsigned sizeFromType( std::string type_name )
   {
          if( type_name == "mat4"     ) return sizeof( float    ) * 16 ;
@@ -57,162 +96,1016 @@ namespace nyx
     else { std::cout << "Unknown type : " << type_name << std::endl ; exit( -1 ) ; } ;
   }
 
-  /** Structure to encompass a shader uniform.
-   */
-  struct Uniform
+  const char* errorString( NyxError error )
   {
-    unsigned    binding ; ///< TODO
-    unsigned    size    ; ///< TODO
-    UniformType type    ; ///< TODO
-    std::string name    ; ///< TODO
-  };
+    switch( error )
+    {
+      case NyxError::NoError            : return "No error"                                ;
+      case NyxError::UnableToOpen       : return "Unable to open file"                     ;
+      case NyxError::BadMagic           : return "Not a .nyx file"                         ;
+      case NyxError::UnsupportedVersion : return "Unsupported .nyx version"                ;
+      case NyxError::TruncatedFile      : return "File is truncated"                       ;
+      case NyxError::TruncatedSection   : return "Section reaches past the end of the file" ;
+      case NyxError::MisalignedSection  : return "Section is misaligned"                   ;
+      case NyxError::CountOverflow      : return "Count exceeds the size of its data"      ;
+      case NyxError::CorruptSpirv       : return "Compressed SPIRV is corrupt"             ;
+      case NyxError::ChecksumMismatch   : return "Checksum mismatch"                       ;
+      case NyxError::BadHeader          : return "Header is corrupt"                       ;
+      case NyxError::BadStringPool      : return "String section is missing or corrupt"    ;
+      default                           : return "Unknown error"                           ;
+    }
+  }
 
-  /** Structure to encompass a shader attribute.
-   */
-  struct Attribute
+  namespace
   {
-    std::string name     ; ///< TOOD
-    std::string type     ; ///< TOOD
-    unsigned    size     ; ///< TOOD
-    unsigned    location ; ///< TOOD
-  };
+    /** Structure to encompass a shader uniform.
+     */
+    struct Uniform
+    {
+      unsigned    binding ; ///< TODO
+      unsigned    size    ; ///< TODO
+      UniformType type    ; ///< TODO
+      const char* name    ; ///< TODO
+    };
 
-  /** Structure to encompass a shader.
-   */
-  struct Shader
-  {
-    typedef std::vector<unsigned>   SpirVData     ;
-    typedef std::vector<Uniform>    UniformList   ;
+    /** Structure to encompass a shader attribute.
+     */
+    struct Attribute
+    {
+      const char* name     ; ///< TOOD
+      const char* type     ; ///< TOOD
+      unsigned    size     ; ///< TOOD
+      unsigned    location ; ///< TOOD
+    };
+
+    /** Structure to serialize decoding the data that is only decoded once it is first used.
+     * Guards are never copied. Objects holding one are only ever reset by assigning a fresh object, which keeps the lock.
+     */
+    struct Guard
+    {
+      mutable std::mutex lock ; ///< The lock to hold while decoding.
+
+      /** Default constructor.
+       */
+      Guard() = default ;
+
+      /** A lock only ever guards the object it is a member of, so guards cannot be copied.
+       */
+      Guard( const Guard& guard ) = delete ;
+
+      /** Assignment operator. Keeps this object's own lock.
+       * @param guard The object being assigned.
+       * @return Reference to this object.
+       */
+      Guard& operator=( const Guard& guard ) ;
+    };
+
+    /** Structure to resolve the strings of a .nyx file, wherever they live.
+     * Resolved strings stay valid for as long as any copy of this object does.
+     */
+    struct Strings
+    {
+      /** Structure to own strings, shared by every copy of the object that created it.
+       */
+      struct Arena
+      {
+        std::deque<std::string> strings ; ///< The owned strings, which never move once added.
+        std::mutex              lock    ; ///< The lock to hold while adding strings, as copies may add from many threads.
+      };
+
+      const char*            pool      = nullptr ; ///< The string section of the file, if it has one.
+      unsigned               pool_size = 0       ; ///< The size in bytes of the string section.
+      std::shared_ptr<Arena> owned               ; ///< Storage for strings that could not be referenced in place.
+
+      /** Method to read a string, either as an offset into the string section or inline.
+       * @param cursor The cursor to read from.
+       * @return The C-string that has been read.
+       */
+      const char* read( Cursor& cursor ) ;
+    };
+
+    /** Structure to look names up by in constant time.
+     * The table either comes from the file, or is built the first time a name is looked up.
+     */
+    struct NameTable
+    {
+      const unsigned char*       mapped      = nullptr ; ///< The buckets inside of the source bytes, if the file has a table.
+      std::vector<NyxNameBucket> owned                 ; ///< The buckets, if they were copied out of the file or built at runtime.
+      unsigned                   num_buckets = 0       ; ///< The amount of buckets of the table, or 0 if there is none yet.
+      Guard                      guard                 ; ///< The guard to hold while looking up, as the table may be built by the first lookup.
+
+      /** Method to assign this table from a section of a file.
+       * @param cursor The cursor over the section.
+       * @param reference Whether the buckets may be read from the bytes in place, which must then outlive this table.
+       */
+      void assign( Cursor& cursor, bool reference ) ;
+
+      /** Method to retrieve a bucket of this table.
+       * @param index The index of the bucket.
+       * @return The bucket at that index.
+       */
+      NyxNameBucket bucket( unsigned index ) const ;
+
+      /** Method to find the index of a name in a list.
+       * @param name The C-string name to look for.
+       * @param list The list of items with names, that this table was built for.
+       * @return The index of the first item in the list with that name, or UINT_MAX if there is none.
+       */
+      template<typename List>
+      unsigned find( const char* name, const List& list ) ;
+    };
+
+    /** Structure to encompass a shader.
+     */
+    struct Shader
+    {
+      typedef std::vector<unsigned>   SpirVData     ;
+      typedef std::vector<Uniform>    UniformList   ;
     
-    UniformList   uniforms   ;
-    SpirVData     spirv      ;
-    ShaderStage   stage      ;
-    std::string   name       ;
-  };
+      mutable UniformList          uniforms        = {}      ; ///< The uniforms of this shader stage.
+      mutable const unsigned char* reflection      = nullptr ; ///< The reflection section of this stage, if it has yet to be decoded.
+      mutable unsigned             reflection_size = 0       ; ///< The size in bytes of the undecoded reflection section.
+      mutable Strings              strings                   ; ///< The strings the uniforms' names resolve into.
+      mutable NameTable            uniform_table             ; ///< The table to look uniforms up by name with.
+      mutable SpirVData            spirv           = {}      ; ///< Owned SPIRV, only used when the source bytes can't be referenced directly.
+      const unsigned*              mapped          = nullptr ; ///< The SPIRV inside of the source bytes, when it can be referenced directly.
+      mutable const unsigned char* packed          = nullptr ; ///< The compressed SPIRV inside of the source bytes, if it has yet to be decoded.
+      mutable unsigned long long   packed_size     = 0       ; ///< The size in bytes of the compressed SPIRV.
+      unsigned                     spirv_size      = 0       ; ///< The amount of SPIRV words in this shader stage.
+      ShaderStage                  stage                     ; ///< The stage of this shader.
+      std::string                  name                      ; ///< The name of this shader.
+      Guard                        guard                     ; ///< The guard to hold while decoding SPIRV or uniforms.
+
+      /** Method to retrieve the SPIRV code of this shader, wherever it lives, decoding it first if it is compressed.
+       * @return Pointer to the SPIRV words of this shader, or nullptr if they could not be decoded.
+       */
+      const unsigned* code() const ;
+
+      /** Method to copy the SPIRV code of this shader into a buffer, decoding it straight into it if it is compressed.
+       * @param words The buffer to copy into, which must hold spirv_size words.
+       * @return Whether or not the SPIRV could be decoded.
+       */
+      bool copy( unsigned* words ) const ;
+
+      /** Method to decode the uniforms of this shader if that was deferred.
+       * @return Whether or not the uniforms fit their section. If not, this shader is left without any.
+       */
+      bool decode() const ;
+
+      /** Method to retrieve the uniforms of this shader, decoding them first if that was deferred.
+       * @return Reference to the list of this shader's uniforms.
+       */
+      const UniformList& reflect() const ;
+    };
+
+    /** Structure to decode values from a contiguous range of bytes, in place.
+     * Reads past the end of the range yield zeroes instead of touching memory outside of it.
+     */
+    struct Cursor
+    {
+      const unsigned char* ptr ; ///< The current read position.
+      const unsigned char* end ; ///< One past the last readable byte.
+
+      /** Constructor. Initializes this cursor over the input range of bytes.
+       * @param bytes The first byte of the range to read.
+       * @param size The amount of bytes in the range.
+       */
+      Cursor( const unsigned char* bytes, unsigned long long size ) ;
+
+      /** Method to retrieve the amount of bytes left to read.
+       * @return The amount of bytes between the read position and the end of the range.
+       */
+      unsigned long long remaining() const ;
+
+      /** Method to consume the input amount of bytes.
+       * @param amount The amount of bytes to consume.
+       * @return Pointer to the first consumed byte, or nullptr if the range does not contain that many bytes.
+       */
+      const unsigned char* take( unsigned long long amount ) ;
+
+      /** Method to read a string.
+       * @return The string that has been read.
+       */
+      std::string readString() ;
+
+      /** Method to read an unsigned integer.
+       * @return The unsigned integer that has been read.
+       */
+      unsigned readUnsigned() ;
+
+      /** Method to read a magic number.
+       * @return The magic number read.
+       */
+      unsigned long long readMagic() ;
+    };
+  }
 
-  struct ShaderIteratorData
-  {
-    ShaderMap::const_iterator it ;
-  };
-  
   /** Container for a KgFile's data.
    */
   struct NyxFileData
   {
-    using AttributeList = std::vector<Attribute> ;
+    using AttributeList = std::vector<Attribute>          ;
+    using BindingList   = std::vector<NyxBinding>         ;
+    using VertexList    = std::vector<NyxVertexAttribute> ;
+
+    mutable AttributeList         inputs                      ;
+    mutable AttributeList         outputs                     ;
+    mutable const unsigned char*  pipeline          = nullptr ; ///< The pipeline section, if it has yet to be decoded.
+    mutable unsigned              pipeline_size     = 0       ; ///< The size in bytes of the undecoded pipeline section.
+    std::string                   include_directory           ;
+    Shader                        stages[ NUM_STAGES ]        ; ///< The shader stages of this file, indexed by ShaderStage.
+    unsigned                      present           = 0       ; ///< The mask of which shader stages this file contains.
+    unsigned                      version                     ;
+    bool                          lazy              = false   ; ///< Whether reflection decoding is deferred until it is first used.
+    bool                          verify            = false   ; ///< Whether the checksums of checksummed files are checked before decoding.
+    bool                          archived          = false   ; ///< Whether the file lives inside of an archive, with the archive's shared SPIRV following it.
+    Guard                         guard                       ; ///< The guard to hold while decoding the pipeline's inputs & outputs.
+    mutable const NyxBinding*     binding_table     = nullptr ; ///< The merged descriptor bindings, wherever they live.
+    mutable unsigned              num_bindings      = 0       ; ///< The amount of merged descriptor bindings.
+    mutable bool                  has_bindings      = false   ; ///< Whether the bindings came from the file or have been merged yet.
+    mutable BindingList           owned_bindings              ; ///< The bindings, if they were copied out of the file or merged at runtime.
+    Guard                         binding_guard               ; ///< The guard to hold while merging the bindings.
+    const NyxVertexAttribute*     vertex_table      = nullptr ; ///< The vertex input layout, wherever it lives.
+    unsigned                      num_vertex        = 0       ; ///< The amount of vertex attributes.
+    unsigned                      vertex_stride     = 0       ; ///< The size in bytes of a single interleaved vertex.
+    VertexList                    owned_vertex                ; ///< The vertex attributes, if they were copied out of the file.
+    std::atomic<unsigned>         references        { 1 }     ; ///< The amount of NyxFile objects sharing this data.
+    NyxError                      error             = NoError ; ///< Why the last load failed, if it did.
+    mutable Strings               strings                     ; ///< The strings the attributes' names & types resolve into.
+    mutable NameTable             input_table                 ; ///< The table to look inputs up by name with.
+    mutable NameTable             output_table                ; ///< The table to look outputs up by name with.
+    std::shared_ptr<MappedFile>   file                        ; ///< The mapping the loaded SPIRV points into, if any.
+
+    /** Method to retrieve the merged descriptor bindings, merging them out of every stage's uniforms if the file has none.
+     * @param count Set to the amount of bindings.
+     * @return Pointer to the first binding, or nullptr if there are none.
+     */
+    const NyxBinding* bindings( unsigned& count ) const ;
+
+    /** Method to assign the merged descriptor bindings from a file's BindingSection.
+     * @param payload The cursor over the BindingSection.
+     * @param reference Whether the bindings may be read from the bytes in place, which must then outlive this file.
+     * @return Whether or not the section holds as many bindings as it claims to.
+     */
+    bool assignBindings( Cursor& payload, bool reference ) ;
+
+    /** Method to assign the vertex input layout from a file's VertexInputSection.
+     * @param payload The cursor over the VertexInputSection.
+     * @param reference Whether the attributes may be read from the bytes in place, which must then outlive this file.
+     * @return Whether or not the section holds as many attributes as it claims to.
+     */
+    bool assignVertexInput( Cursor& payload, bool reference ) ;
+
+    /** Method to decode the pipeline's inputs & outputs if that was deferred.
+     * @return Whether or not the inputs & outputs fit their section. If not, only the ones that did are kept.
+     */
+    bool reflect() const ;
+
+    /** Method to retrieve the shader of a stage, marking the stage as contained in this file.
+     * @param stage The value of the shader stage to retrieve.
+     * @return Pointer to the shader of the stage, or nullptr if the value isn't a valid ShaderStage.
+     */
+    Shader* shader( unsigned stage ) ;
 
-    AttributeList inputs            ;
-    AttributeList outputs           ;
-    std::string   include_directory ;
-    ShaderMap     map               ;
-    unsigned      version           ;
+    /** Method to find the next shader stage this file contains.
+     * @param index The index of the stage to start looking at.
+     * @return The index of the first contained stage at or after the input, or NUM_STAGES if there is none.
+     */
+    unsigned next( unsigned index ) const ;
+
+    /** Method to release every decoded shader stage & attribute.
+     */
+    void clear() ;
+
+    /** Method to replace this file's contents with a .nyx file decoded from a range of bytes, recording why if it fails.
+     * @param bytes The first byte of the .nyx file's data.
+     * @param size The amount of bytes in the .nyx file's data.
+     * @param reference Whether SPIRV may point into the bytes, which must then outlive the decoded shaders.
+     * @return Whether or not the bytes are a valid .nyx file. If not, this file is left empty.
+     */
+    bool load( const unsigned char* bytes, unsigned long long size, bool reference ) ;
+
+    /** Method to decode a .nyx file from a range of bytes.
+     * @param bytes The first byte of the .nyx file's data.
+     * @param size The amount of bytes in the .nyx file's data.
+     * @param reference Whether SPIRV may point into the bytes, which must then outlive the decoded shaders.
+     * @return The reason the bytes aren't a valid .nyx file, or NoError if they are.
+     */
+    NyxError parse( const unsigned char* bytes, unsigned long long size, bool reference ) ;
 
-    /** Method to read a string from a file stream
-     * @param stream The stream to read from
-     * @return The string that has been read.
+    /** Method to decode the sequential layout of a version 1 .nyx file.
+     * @param cursor The cursor positioned right after the file's version.
+     * @param reference Whether SPIRV may point into the bytes, which must then outlive the decoded shaders.
+     * @return The reason the file couldn't be read, or NoError if every shader stage it claims to have was.
      */
-    std::string readString( std::istream& stream ) const ;
+    NyxError parseVersion1( Cursor& cursor, bool reference ) ;
 
-    /** Method to read an unsigned integer from a file stream
-     * @param stream The stream to read from.
-     * @return The unsigned integer that has been read.
+    /** Method to decode the sectioned layout of a version 2 .nyx file.
+     * @param bytes The first byte of the .nyx file's data.
+     * @param size The amount of bytes in the .nyx file's data.
+     * @param reference Whether SPIRV may point into the bytes, which must then outlive the decoded shaders.
+     * @return The reason the file couldn't be read, or NoError if it was.
      */
-    unsigned readUnsigned( std::istream& stream ) const ;
+    NyxError parseVersion2( const unsigned char* bytes, unsigned long long size, bool reference ) ;
 
-    /** Method to read a boolean from a file stream.
-     * @param stream The stream to read from.
-     * @return The boolean that has been read.
+    /** Method to check the section table & every section of a version 2 .nyx file against the file's ChecksumSection.
+     * @param bytes The first byte of the .nyx file's data.
+     * @param header The file's header.
+     * @param table The file's complete section table, already known to lie inside of the file.
+     * @return Whether or not the table and every section match their checksums.
      */
-    bool readBoolean( std::istream& stream ) const ;
+    bool verifySections( const unsigned char* bytes, const NyxHeader& header, const std::vector<NyxSection>& table ) const ;
 
-    /** Method to read a magic number from a file stream.
-     * @param stream The stream to read from.
-     * @return The magic number read.
+    /** Method to assign SPIRV to a shader stage, either by reference or by copy.
+     * @param shader The shader to assign the SPIRV of.
+     * @param spirv The first byte of the SPIRV.
+     * @param size The amount of SPIRV words.
+     * @param reference Whether SPIRV may point into the bytes, which must then outlive the decoded shaders.
      */
-    unsigned long long readMagic( std::istream& stream ) const ;
+    void assignSpirv( Shader& shader, const unsigned char* spirv, unsigned size, bool reference ) const ;
 
-    /** Method to read SPIRV binary data from a file stream.
-     * @param stream The stream to read from.
-     * @param sz The side of the binary data that is in the stream.
-     * @return Pointer to allocated memory of the loaded spirv binary.
+    /** Method to assign compressed SPIRV to a shader stage, either by reference or by decoding it right away.
+     * @param shader The shader to assign the SPIRV of.
+     * @param payload The cursor over the stage's CompressedSpirvSection.
+     * @param reference Whether the compressed SPIRV may be decoded later, out of the bytes which must then outlive the decoded shaders.
+     * @return The reason the compressed SPIRV is invalid, or NoError if it isn't as far as can be told yet.
      */
-    unsigned* readSpirv( std::istream& stream, unsigned sz ) const ;
+    NyxError assignPacked( Shader& shader, Cursor& payload, bool reference ) const ;
   };
 
-  std::string NyxFileData::readString( std::istream& stream ) const
+  Guard& Guard::operator=( const Guard& )
+  {
+    return *this ;
+  }
+
+  const unsigned* Shader::code() const
+  {
+    std::lock_guard<std::mutex> lock( this->guard.lock ) ;
+
+    if( this->packed )
+    {
+      this->spirv.resize( this->spirv_size ) ;
+      if( !decodeSpirv( this->packed, this->packed_size, this->spirv.data(), this->spirv_size ) ) this->spirv.clear() ;
+      this->packed = nullptr ;
+
+      if( this->spirv.empty() ) return nullptr ;
+    }
+
+    return this->spirv.empty() ? this->mapped : this->spirv.data() ;
+  }
+
+  bool Shader::copy( unsigned* words ) const
+  {
+    const unsigned* code ;
+
+    // Compressed SPIRV that has yet to be decoded goes straight into the buffer, without a copy in between.
+    {
+      std::lock_guard<std::mutex> lock( this->guard.lock ) ;
+      if( this->packed ) return decodeSpirv( this->packed, this->packed_size, words, this->spirv_size ) ;
+    }
+
+    code = this->code() ;
+    if( !code && this->spirv_size != 0 ) return false ;
+
+    if( code ) memcpy( words, code, static_cast<unsigned long long>( this->spirv_size ) * sizeof( unsigned ) ) ;
+    return true ;
+  }
+
+  bool Shader::decode() const
+  {
+    std::lock_guard<std::mutex> lock( this->guard.lock ) ;
+
+    if( this->reflection )
+    {
+      Cursor cursor( this->reflection, this->reflection_size ) ;
+
+      this->reflection = nullptr ;
+      if( !readUniforms( cursor, this->strings, cursor.readUnsigned(), this->uniforms ) ) return false ;
+    }
+
+    return true ;
+  }
+
+  const Shader::UniformList& Shader::reflect() const
+  {
+    this->decode() ;
+    return this->uniforms ;
+  }
+
+  const NyxBinding* NyxFileData::bindings( unsigned& count ) const
+  {
+    std::lock_guard<std::mutex> lock( this->binding_guard.lock ) ;
+
+    // Files without a binding table get one merged the same way the writer does, only without knowing descriptor sets.
+    if( !this->has_bindings )
+    {
+      std::map<unsigned, NyxBinding> merged ;
+
+      for( unsigned index = this->next( 0 ); index < NUM_STAGES; index = this->next( index + 1 ) )
+      {
+        for( const auto& uniform : this->stages[ index ].reflect() )
+        {
+          const unsigned count = std::max( 1u, uniform.size ) ;
+
+          auto iter = merged.emplace( uniform.binding, NyxBinding{ 0, uniform.binding, uniform.type, count, 0 } ).first ;
+
+          iter->second.count   = std::max( iter->second.count, count ) ;
+          iter->second.stages |= 1u << index                          ;
+        }
+      }
+
+      for( const auto& entry : merged ) this->owned_bindings.push_back( entry.second ) ;
+
+      this->binding_table = this->owned_bindings.data() ;
+      this->num_bindings  = this->owned_bindings.size() ;
+      this->has_bindings  = true                         ;
+    }
+
+    count = this->num_bindings ;
+    return this->num_bindings != 0 ? this->binding_table : nullptr ;
+  }
+
+  bool NyxFileData::assignBindings( Cursor& payload, bool reference )
+  {
+    const unsigned           count    = payload.readUnsigned()                                        ;
+    const unsigned           reserved = payload.readUnsigned()                                        ;
+    const unsigned long long size     = static_cast<unsigned long long>( count ) * sizeof( NyxBinding ) ;
+
+    if( reserved != 0 || size > payload.remaining() ) return false ;
+
+    // Bindings are handed out as an array, so they can only be read in place if they are suitably aligned.
+    if( reference && reinterpret_cast<uintptr_t>( payload.ptr ) % alignof( NyxBinding ) == 0 )
+    {
+      this->binding_table = reinterpret_cast<const NyxBinding*>( payload.ptr ) ;
+    }
+    else if( count != 0 )
+    {
+      // Empty tables are skipped, as an empty vector's data() is null and can't be copied into, even zero bytes.
+      this->owned_bindings.resize( count ) ;
+      memcpy( this->owned_bindings.data(), payload.ptr, size ) ;
+      this->binding_table = this->owned_bindings.data() ;
+    }
+
+    this->num_bindings = count ;
+    this->has_bindings = true  ;
+    return true ;
+  }
+
+  bool NyxFileData::assignVertexInput( Cursor& payload, bool reference )
   {
-    unsigned    sz  ;
-    std::string out ;
+    const unsigned           count  = payload.readUnsigned()                                                ;
+    const unsigned           stride = payload.readUnsigned()                                                ;
+    const unsigned long long size   = static_cast<unsigned long long>( count ) * sizeof( NyxVertexAttribute ) ;
 
-    stream.read( (char*)&sz, sizeof( unsigned ) ) ;
-    out.resize( sz ) ;
-    stream.read( (char*)out.data(), sz ) ;
+    if( size > payload.remaining() ) return false ;
+
+    if( reference && reinterpret_cast<uintptr_t>( payload.ptr ) % alignof( NyxVertexAttribute ) == 0 )
+    {
+      this->vertex_table = reinterpret_cast<const NyxVertexAttribute*>( payload.ptr ) ;
+    }
+    else if( count != 0 )
+    {
+      // As with the bindings, an empty layout is skipped rather than copied into a null data().
+      this->owned_vertex.resize( count ) ;
+      memcpy( this->owned_vertex.data(), payload.ptr, size ) ;
+      this->vertex_table = this->owned_vertex.data() ;
+    }
+
+    this->num_vertex    = count  ;
+    this->vertex_stride = stride ;
+    return true ;
+  }
+
+  bool NyxFileData::reflect() const
+  {
+    std::lock_guard<std::mutex> lock( this->guard.lock ) ;
+
+    if( this->pipeline )
+    {
+      Cursor cursor( this->pipeline, this->pipeline_size ) ;
+
+      const unsigned num_inputs  = cursor.readUnsigned() ;
+      const unsigned num_outputs = cursor.readUnsigned() ;
+
+      this->pipeline = nullptr ;
+      if( !readAttributes( cursor, this->strings, num_inputs , this->inputs  ) ) return false ;
+      if( !readAttributes( cursor, this->strings, num_outputs, this->outputs ) ) return false ;
+    }
+
+    return true ;
+  }
+
+  Shader* NyxFileData::shader( unsigned stage )
+  {
+    if( stage >= NUM_STAGES ) return nullptr ;
+
+    this->present |= 1u << stage ;
+    this->stages[ stage ].stage = static_cast<ShaderStage>( stage ) ;
+    return &this->stages[ stage ] ;
+  }
+
+  unsigned NyxFileData::next( unsigned index ) const
+  {
+    while( index < NUM_STAGES && !( this->present & ( 1u << index ) ) ) index++ ;
+    return index ;
+  }
+
+  const char* Strings::read( Cursor& cursor )
+  {
+    if( this->pool )
+    {
+      const unsigned offset = cursor.readUnsigned() ;
+
+      // The string section always ends in a terminator, so any offset inside of it is a valid C-string.
+      return offset < this->pool_size ? this->pool + offset : "" ;
+    }
+
+    std::lock_guard<std::mutex> lock( this->owned->lock ) ;
+
+    this->owned->strings.push_back( cursor.readString() ) ;
+    return this->owned->strings.back().c_str() ;
+  }
+
+  void NameTable::assign( Cursor& cursor, bool reference )
+  {
+    const unsigned           num_buckets = cursor.readUnsigned()                                               ;
+    const unsigned           reserved    = cursor.readUnsigned()                                               ;
+    const unsigned long long size        = static_cast<unsigned long long>( num_buckets ) * sizeof( NyxNameBucket ) ;
+
+    this->mapped      = nullptr ;
+    this->num_buckets = 0       ;
+    this->owned.clear() ;
+
+    // A table that isn't a power of two in size or doesn't fit its section is ignored, and rebuilt when needed.
+    if( reserved != 0 || num_buckets == 0 || ( num_buckets & ( num_buckets - 1 ) ) != 0 || cursor.remaining() < size ) return ;
+
+    if( reference )
+    {
+      this->mapped = cursor.ptr ;
+    }
+    else
+    {
+      this->owned.resize( num_buckets ) ;
+      memcpy( this->owned.data(), cursor.ptr, size ) ;
+    }
+
+    this->num_buckets = num_buckets ;
+  }
+
+  NyxNameBucket NameTable::bucket( unsigned index ) const
+  {
+    NyxNameBucket out ;
+
+    if( this->owned.empty() ) memcpy( &out, this->mapped + index * sizeof( NyxNameBucket ), sizeof( NyxNameBucket ) ) ;
+    else                      out = this->owned[ index ] ;
 
     return out ;
   }
 
-  unsigned NyxFileData::readUnsigned( std::istream& stream ) const
+  template<typename List>
+  unsigned NameTable::find( const char* name, const List& list )
   {
-    unsigned val ;
+    const unsigned hash = hashName( name ) ;
+    unsigned       slot                    ;
 
-    stream.read( (char*)&val, sizeof( unsigned ) ) ;
-    return val ;
+    std::lock_guard<std::mutex> lock( this->guard.lock ) ;
+
+    if( this->num_buckets == 0 )
+    {
+      this->num_buckets = nameBuckets( list.size() ) ;
+      this->owned.assign( this->num_buckets, NyxNameBucket{ 0, 0 } ) ;
+      for( unsigned index = 0; index < list.size(); index++ )
+      {
+        insertName( this->owned.data(), this->num_buckets, hashName( list[ index ].name ), index ) ;
+      }
+    }
+
+    // Probes are bounded by the table's size, in case a table from a file has no empty bucket to stop on.
+    slot = hash & ( this->num_buckets - 1 ) ;
+    for( unsigned probe = 0; probe < this->num_buckets; probe++ )
+    {
+      const NyxNameBucket entry = this->bucket( slot ) ;
+
+      if( entry.index == 0 ) break ;
+      if( entry.hash == hash && entry.index - 1 < list.size() && strcmp( list[ entry.index - 1 ].name, name ) == 0 )
+      {
+        return entry.index - 1 ;
+      }
+
+      slot = ( slot + 1 ) & ( this->num_buckets - 1 ) ;
+    }
+
+    return UINT_MAX ;
+  }
+
+  Cursor::Cursor( const unsigned char* bytes, unsigned long long size )
+  {
+    this->ptr = bytes        ;
+    this->end = bytes + size ;
+  }
+
+  unsigned long long Cursor::remaining() const
+  {
+    return static_cast<unsigned long long>( this->end - this->ptr ) ;
   }
 
-  bool NyxFileData::readBoolean( std::istream& stream ) const
+  const unsigned char* Cursor::take( unsigned long long amount )
   {
-    bool val ;
+    const unsigned char* out = this->ptr ;
 
-    stream.read( (char*)&val, sizeof( bool ) ) ;
+    if( amount > this->remaining() )
+    {
+      this->ptr = this->end ;
+      return nullptr ;
+    }
+
+    this->ptr += amount ;
+    return out ;
+  }
+
+  std::string Cursor::readString()
+  {
+    const unsigned       sz    = this->readUnsigned() ;
+    const unsigned char* chars = this->take( sz )      ;
+
+    return chars ? std::string( reinterpret_cast<const char*>( chars ), sz ) : std::string() ;
+  }
+
+  unsigned Cursor::readUnsigned()
+  {
+    const unsigned char* bytes = this->take( sizeof( unsigned ) ) ;
+    unsigned             val   = 0                                ;
+
+    if( bytes ) memcpy( &val, bytes, sizeof( unsigned ) ) ;
     return val ;
   }
 
-  unsigned long long NyxFileData::readMagic( std::istream& stream ) const
+  unsigned long long Cursor::readMagic()
   {
-    unsigned long long val ;
+    const unsigned char* bytes = this->take( sizeof( unsigned long long ) ) ;
+    unsigned long long   val   = 0                                          ;
 
-    stream.read( (char*)&val, sizeof( unsigned long long ) ) ;
+    if( bytes ) memcpy( &val, bytes, sizeof( unsigned long long ) ) ;
     return val ;
   }
 
-  unsigned* NyxFileData::readSpirv( std::istream& stream, unsigned sz ) const
+  void NyxFileData::clear()
+  {
+    for( auto& stage : this->stages ) stage = Shader() ;
+
+    this->inputs .clear() ;
+    this->outputs.clear() ;
+    this->present      = 0           ;
+    this->pipeline     = nullptr     ;
+    this->input_table  = NameTable() ;
+    this->output_table = NameTable() ;
+    this->strings      = Strings()   ;
+    this->strings.owned = std::make_shared<Strings::Arena>() ;
+
+    this->binding_table = nullptr ;
+    this->num_bindings  = 0       ;
+    this->has_bindings  = false   ;
+    this->owned_bindings.clear() ;
+
+    this->vertex_table  = nullptr ;
+    this->num_vertex    = 0       ;
+    this->vertex_stride = 0       ;
+    this->owned_vertex.clear() ;
+  }
+
+  bool NyxFileData::load( const unsigned char* bytes, unsigned long long size, bool reference )
   {
-    unsigned* data = new unsigned[ sz ] ;
-    stream.read( (char*)data, sz * sizeof( unsigned ) ) ;
+    this->clear() ;
+
+    // A file that fails to load is left empty, rather than holding whatever was decoded before the error.
+    this->error = this->parse( bytes, size, reference ) ;
+    if( this->error != NyxError::NoError ) this->clear() ;
 
-    return data ;
+    return this->error == NyxError::NoError ;
+  }
+
+  NyxError NyxFileData::parse( const unsigned char* bytes, unsigned long long size, bool reference )
+  {
+    Cursor cursor( bytes, size ) ;
+
+    if( cursor.readMagic() != ::nyx::MAGIC ) return NyxError::BadMagic ;
+
+    this->version = cursor.readUnsigned() ;
+
+    if( this->version == 1               ) return this->parseVersion1( cursor, reference       ) ;
+    if( this->version == NYXFILE_VERSION ) return this->parseVersion2( bytes, size, reference ) ;
+
+    return NyxError::UnsupportedVersion ;
+  }
+
+  NyxError NyxFileData::parseVersion1( Cursor& cursor, bool reference )
+  {
+    unsigned num_shaders ;
+    unsigned num_inputs  ;
+    unsigned num_outputs ;
+
+    num_shaders = cursor.readUnsigned() ;
+    num_inputs  = cursor.readUnsigned() ;
+    num_outputs = cursor.readUnsigned() ;
+
+    if( !readAttributes( cursor, this->strings, num_inputs , this->inputs  ) ) return NyxError::CountOverflow ;
+    if( !readAttributes( cursor, this->strings, num_outputs, this->outputs ) ) return NyxError::CountOverflow ;
+
+    // Every shader takes at least its SPIRV size, its stage & its amount of uniforms.
+    if( static_cast<unsigned long long>( num_shaders ) * 3 * sizeof( unsigned ) > cursor.remaining() ) return NyxError::CountOverflow ;
+
+    for( unsigned it = 0; it < num_shaders; it++ )
+    {
+      const unsigned           spirv_size  = cursor.readUnsigned()                                             ;
+      const unsigned long long spirv_bytes = static_cast<unsigned long long>( spirv_size ) * sizeof( unsigned ) ;
+      const unsigned char*     spirv       = cursor.take( spirv_bytes )                                        ;
+      const unsigned           stage       = cursor.readUnsigned()                                             ;
+      const unsigned           num_unifs   = cursor.readUnsigned()                                             ;
+
+      if( !spirv ) return NyxError::TruncatedFile ;
+
+      Shader  discard            ;
+      Shader* shader  = &discard ;
+
+      // Only the first occurence of a stage is kept, but the uniforms of any other still have to be read past.
+      if( stage < NUM_STAGES && !( this->present & ( 1u << stage ) ) ) shader = this->shader( stage ) ;
+
+      this->assignSpirv( *shader, spirv, spirv_size, reference ) ;
+      if( !readUniforms( cursor, this->strings, num_unifs, shader->uniforms ) ) return NyxError::CountOverflow ;
+    }
+
+    return NyxError::NoError ;
+  }
+
+  NyxError NyxFileData::parseVersion2( const unsigned char* bytes, unsigned long long size, bool reference )
+  {
+    std::vector<NyxSection> table   ;
+    NyxHeader               header  ;
+    NyxError                error   ;
+    Cursor                  cursor( bytes, size ) ;
+
+    // Reflection can only be left for later if the bytes it lives in are kept around.
+    const bool deferred = this->lazy && reference ;
+
+    const unsigned char* raw_header = cursor.take( sizeof( NyxHeader ) ) ;
+    if( !raw_header ) return NyxError::TruncatedFile ;
+    memcpy( &header, raw_header, sizeof( NyxHeader ) ) ;
+
+    // The file's size isn't covered by its checksum, as archiving changes it, so it is checked against the bytes instead.
+    // Only a file inside of an archive may have more bytes after it, which hold the archive's shared SPIRV.
+    if( header.reserved != 0                       ) return NyxError::BadHeader     ;
+    if( header.file_size > size                    ) return NyxError::TruncatedFile ;
+    if( header.file_size < size && !this->archived ) return NyxError::BadHeader     ;
+
+    const unsigned char* raw_table = cursor.take( static_cast<unsigned long long>( header.num_sections ) * sizeof( NyxSection ) ) ;
+    if( !raw_table ) return NyxError::TruncatedFile ;
+
+    table.resize( header.num_sections ) ;
+    memcpy( table.data(), raw_table, table.size() * sizeof( NyxSection ) ) ;
+
+    // Sections are only ever read through the table, so nothing is decoded unless all of it points inside of the file.
+    for( const auto& entry : table )
+    {
+      if( static_cast<unsigned long long>( entry.offset ) + entry.size > size            ) return NyxError::TruncatedSection  ;
+      if( ( header.flags & AlignedSections ) && entry.offset % SECTION_ALIGNMENT != 0 ) return NyxError::MisalignedSection ;
+    }
+
+    // Nothing is decoded before every section is known to be intact either. The flags can't be trusted before that, so when
+    // verifying, a file is checked whenever it has a ChecksumSection, and rejected if it has none.
+    if( this->verify && !this->verifySections( bytes, header, table ) ) return NyxError::ChecksumMismatch ;
+
+    // Everything else may refer to the string section, so it has to be found first.
+    for( const auto& entry : table )
+    {
+      const char* pool = reinterpret_cast<const char*>( bytes + entry.offset ) ;
+
+      if( entry.type == SectionType::StringSection && ( header.flags & PooledStrings ) )
+      {
+        // Pooled names are offsets into this section, which can't be read as anything else.
+        if( entry.size == 0 || pool[ entry.size - 1 ] != '\0' ) return NyxError::BadStringPool ;
+
+        if( !reference )
+        {
+          this->strings.owned->strings.emplace_back( pool, entry.size ) ;
+          pool = this->strings.owned->strings.back().data() ;
+        }
+
+        this->strings.pool      = pool       ;
+        this->strings.pool_size = entry.size ;
+      }
+    }
+
+    if( ( header.flags & PooledStrings ) && !this->strings.pool ) return NyxError::BadStringPool ;
+
+    for( const auto& entry : table )
+    {
+      Cursor  payload( bytes + entry.offset, entry.size ) ;
+      Shader* shader = nullptr                           ;
+
+      // Per-stage sections of stages this library doesn't know of are skipped.
+      if( entry.type == SectionType::SpirvSection       || entry.type == SectionType::CompressedSpirvSection ||
+          entry.type == SectionType::ReflectionSection  || entry.type == SectionType::UniformHashSection      )
+      {
+        shader = this->shader( entry.stage ) ;
+        if( !shader ) continue ;
+      }
+
+      switch( entry.type )
+      {
+        case SectionType::PipelineSection :
+        {
+          this->pipeline      = payload.ptr ;
+          this->pipeline_size = entry.size  ;
+          if( !deferred && !this->reflect() ) return NyxError::CountOverflow ;
+          break ;
+        }
+        case SectionType::SpirvSection :
+        {
+          this->assignSpirv( *shader, payload.ptr, entry.size / sizeof( unsigned ), reference ) ;
+          break ;
+        }
+        case SectionType::CompressedSpirvSection :
+        {
+          error = this->assignPacked( *shader, payload, reference ) ;
+          if( error != NyxError::NoError ) return error ;
+          break ;
+        }
+        case SectionType::ReflectionSection :
+        {
+          shader->reflection      = payload.ptr   ;
+          shader->reflection_size = entry.size    ;
+          shader->strings         = this->strings ;
+          if( !deferred && !shader->decode() ) return NyxError::CountOverflow ;
+          break ;
+        }
+        case SectionType::UniformHashSection : shader->uniform_table.assign( payload, reference ) ; break ;
+        case SectionType::InputHashSection  : this->input_table .assign( payload, reference ) ; break ;
+        case SectionType::OutputHashSection : this->output_table.assign( payload, reference ) ; break ;
+        case SectionType::BindingSection :
+        {
+          if( !this->assignBindings( payload, reference ) ) return NyxError::CountOverflow ;
+          break ;
+        }
+        case SectionType::VertexInputSection :
+        {
+          if( !this->assignVertexInput( payload, reference ) ) return NyxError::CountOverflow ;
+          break ;
+        }
+        default : break ;
+      }
+    }
+
+    return NyxError::NoError ;
+  }
+
+  bool NyxFileData::verifySections( const unsigned char* bytes, const NyxHeader& header, const std::vector<NyxSection>& table ) const
+  {
+    const unsigned char* checksums = nullptr ;
+    unsigned             crc                 ;
+
+    for( const auto& entry : table )
+    {
+      if( entry.type == SectionType::ChecksumSection && entry.size >= table.size() * sizeof( unsigned ) )
+      {
+        checksums = bytes + entry.offset ;
+      }
+    }
+
+    if( !checksums ) return false ;
+
+    for( unsigned index = 0; index < table.size(); index++ )
+    {
+      const bool own = table[ index ].type == SectionType::ChecksumSection ;
+
+      memcpy( &crc, checksums + index * sizeof( unsigned ), sizeof( unsigned ) ) ;
+      if(  own && tableChecksum( header, table.data(), table.size() )           != crc ) return false ;
+      if( !own && crc32c( bytes + table[ index ].offset, table[ index ].size ) != crc ) return false ;
+    }
+
+    return true ;
+  }
+
+  bool readAttributes( Cursor& cursor, Strings& strings, unsigned count, std::vector<Attribute>& list )
+  {
+    nyx::Attribute attr ;
+
+    // Every attribute takes at least a name, a type, a size & a location, so a larger count can't be genuine.
+    if( static_cast<unsigned long long>( count ) * MIN_RECORD_SIZE > cursor.remaining() ) return false ;
+
+    list.reserve( list.size() + count ) ;
+    for( unsigned index = 0; index < count; index++ )
+    {
+      attr.name     = strings.read( cursor )  ;
+      attr.type     = strings.read( cursor )  ;
+      attr.size     = cursor.readUnsigned()   ;
+      attr.location = cursor.readUnsigned()   ;
+
+      list.push_back( attr ) ;
+    }
+
+    return true ;
+  }
+
+  bool readUniforms( Cursor& cursor, Strings& strings, unsigned count, std::vector<Uniform>& list )
+  {
+    nyx::Uniform uniform ;
+
+    // Every uniform takes at least a name, a type, a binding & a size, so a larger count can't be genuine.
+    if( static_cast<unsigned long long>( count ) * MIN_RECORD_SIZE > cursor.remaining() ) return false ;
+
+    list.reserve( list.size() + count ) ;
+    for( unsigned index = 0; index < count; index++ )
+    {
+      uniform.name    = strings.read( cursor )                                   ;
+      uniform.type    = static_cast<::nyx::UniformType>( cursor.readUnsigned() ) ;
+      uniform.binding = cursor.readUnsigned()                                    ;
+      uniform.size    = cursor.readUnsigned()                                    ;
+
+      list.push_back( uniform ) ;
+    }
+
+    return true ;
+  }
+
+  void NyxFileData::assignSpirv( Shader& shader, const unsigned char* spirv, unsigned size, bool reference ) const
+  {
+    shader.spirv.clear() ;
+    shader.spirv_size = size    ;
+    shader.mapped     = nullptr ;
+
+    // Only hand out pointers into the source bytes if they stay alive and are suitably aligned to be read as words.
+    if( reference && reinterpret_cast<uintptr_t>( spirv ) % alignof( unsigned ) == 0 )
+    {
+      shader.mapped = reinterpret_cast<const unsigned*>( spirv ) ;
+    }
+    else
+    {
+      shader.spirv.resize( size ) ;
+      memcpy( shader.spirv.data(), spirv, static_cast<unsigned long long>( size ) * sizeof( unsigned ) ) ;
+    }
+  }
+
+  NyxError NyxFileData::assignPacked( Shader& shader, Cursor& payload, bool reference ) const
+  {
+    shader.spirv.clear() ;
+    shader.mapped      = nullptr                  ;
+    shader.spirv_size  = payload.readUnsigned()   ;
+    shader.packed      = payload.ptr              ;
+    shader.packed_size = payload.remaining()      ;
+
+    // Every word takes at least one encoded byte, so the words are never allocated for a count the bytes can't back up.
+    if( shader.spirv_size > shader.packed_size )
+    {
+      shader = Shader() ;
+      return NyxError::CountOverflow ;
+    }
+
+    // Without the bytes around for later, the SPIRV has to be decoded now.
+    if( !reference && !shader.code() ) return NyxError::CorruptSpirv ;
+
+    return NyxError::NoError ;
   }
 
   ShaderIterator::ShaderIterator()
   {
-    this->shader_iterator_data = new ShaderIteratorData() ;
+    this->file_data   = nullptr    ;
+    this->stage_index = NUM_STAGES ;
   }
 
   ShaderIterator::ShaderIterator( const ShaderIterator& input )
   {
-    this->shader_iterator_data = new ShaderIteratorData() ;
+    this->file_data   = input.file_data   ;
+    this->stage_index = input.stage_index ;
+  }
 
-    *this->shader_iterator_data = *input.shader_iterator_data ;
+  ShaderIterator::ShaderIterator( ShaderIterator&& input )
+  {
+    this->file_data   = input.file_data   ;
+    this->stage_index = input.stage_index ;
   }
 
   ShaderIterator::~ShaderIterator()
   {
-    delete this->shader_iterator_data ;
   }
 
   unsigned ShaderIterator::spirvSize() const
   {
-    return data().it->second.spirv.size() ;
+    return data().stages[ this->stage_index ].spirv_size ;
   }
 
   unsigned ShaderIterator::numUniforms() const
   {
-    return data().it->second.uniforms.size() ;
+    return data().stages[ this->stage_index ].reflect().size() ;
   }
 
   const unsigned* ShaderIterator::spirv() const
   {
-    return data().it->second.spirv.data() ;
+    return data().stages[ this->stage_index ].code() ;
+  }
+
+  bool ShaderIterator::decodeSpirv( unsigned* words ) const
+  {
+    return data().stages[ this->stage_index ].copy( words ) ;
   }
 
   const ShaderIterator& ShaderIterator::operator*() const
@@ -222,7 +1115,7 @@ namespace nyx
   
   ShaderStage ShaderIterator::stage() const
   {
-    return data().it->first ;
+    return static_cast<ShaderStage>( this->stage_index ) ;
   }
 
   unsigned ShaderIterator::numAttributes() const
@@ -257,247 +1150,220 @@ namespace nyx
 
   UniformType ShaderIterator::uniformType( unsigned id ) const
   {
-    return id < data().it->second.uniforms.size() ? data().it->second.uniforms[ id ].type : UniformType::None ;
+    const auto& uniforms = data().stages[ this->stage_index ].reflect() ;
+
+    return id < uniforms.size() ? uniforms[ id ].type : UniformType::None ;
   }
 
   unsigned ShaderIterator::uniformSize( unsigned id ) const
   {
-    return id < data().it->second.uniforms.size() ? data().it->second.uniforms[ id ].size : 0 ;
+    const auto& uniforms = data().stages[ this->stage_index ].reflect() ;
+
+    return id < uniforms.size() ? uniforms[ id ].size : 0 ;
   }
 
   unsigned ShaderIterator::uniformBinding( unsigned id ) const
   {
-    return id < data().it->second.uniforms.size() ? data().it->second.uniforms[ id ].binding : UINT_MAX ;
+    const auto& uniforms = data().stages[ this->stage_index ].reflect() ;
+
+    return id < uniforms.size() ? uniforms[ id ].binding : UINT_MAX ;
   }
 
   const char* ShaderIterator::uniformName( unsigned id ) const
   {
-    return id < data().it->second.uniforms.size() ? data().it->second.uniforms[ id ].name.c_str() : "" ;
+    const auto& uniforms = data().stages[ this->stage_index ].reflect() ;
+
+    return id < uniforms.size() ? uniforms[ id ].name : "" ;
+  }
+
+  unsigned ShaderIterator::uniformIndex( const char* name ) const
+  {
+    return data().stages[ this->stage_index ].uniform_table.find( name, data().stages[ this->stage_index ].reflect() ) ;
   }
 
   void ShaderIterator::operator++()
   {
-    ++data().it ;
+    this->stage_index = data().next( this->stage_index + 1 ) ;
   }
 
   ShaderIterator& ShaderIterator::operator=( const ShaderIterator& input )
   {
-    data().it = input.data().it ;
+    this->file_data   = input.file_data   ;
+    this->stage_index = input.stage_index ;
 
     return *this ;
   }
 
-  bool ShaderIterator::operator!=( const ShaderIterator& input ) const
+  ShaderIterator& ShaderIterator::operator=( ShaderIterator&& input )
   {
-    return data().it != input.data().it ;
+    this->file_data   = input.file_data   ;
+    this->stage_index = input.stage_index ;
+
+    return *this ;
   }
 
-  ShaderIteratorData& ShaderIterator::data()
+  bool ShaderIterator::operator!=( const ShaderIterator& input ) const
   {
-    return *this->shader_iterator_data ;
+    return this->stage_index != input.stage_index || this->file_data != input.file_data ;
   }
 
-  const ShaderIteratorData& ShaderIterator::data() const
+  const NyxFileData& ShaderIterator::data() const
   {
-    return *this->shader_iterator_data ;
+    return *this->file_data ;
   }
 
   NyxFile::NyxFile()
   {
-    this->compiler_data = new NyxFileData() ;
+    this->compiler_data    = new NyxFileData() ;
+    this->lazy_reflection  = false             ;
+    this->verify_checksums = false             ;
+  }
+
+  NyxFile::NyxFile( const NyxFile& file )
+  {
+    this->compiler_data    = file.compiler_data    ;
+    this->lazy_reflection  = file.lazy_reflection  ;
+    this->verify_checksums = file.verify_checksums ;
+
+    if( this->compiler_data ) this->compiler_data->references++ ;
+  }
+
+  NyxFile::NyxFile( NyxFile&& file )
+  {
+    this->compiler_data    = file.compiler_data    ;
+    this->lazy_reflection  = file.lazy_reflection  ;
+    this->verify_checksums = file.verify_checksums ;
+    file.compiler_data     = new NyxFileData()     ;
   }
 
   NyxFile::~NyxFile()
   {
-    delete this->compiler_data ;
+    this->release() ;
   }
   
   NyxFile& NyxFile::operator =( const NyxFile& file )
   {
-    *this->compiler_data = *file.compiler_data ;
+    NyxFileData* shared = file.compiler_data ;
+
+    // The input's data is acquired before this object's is released, in case they are one and the same.
+    if( shared ) shared->references++ ;
+    this->release() ;
+
+    this->compiler_data    = shared                ;
+    this->lazy_reflection  = file.lazy_reflection  ;
+    this->verify_checksums = file.verify_checksums ;
     
     return *this ;
   }
 
-  void NyxFile::load( const char* path )
+  NyxFile& NyxFile::operator =( NyxFile&& file )
   {
-    std::ifstream              stream      ;
-    std::string                str         ;
-    unsigned                   num_shaders ;
-    unsigned                   num_inputs  ;
-    unsigned                   num_outputs ;
-    unsigned                   version     ;
-    unsigned long long         magic       ;
-    nyx::Shader                shader      ;
-    nyx::Uniform               uniform     ;
-    nyx::Attribute             attr        ;
+    std::swap( this->compiler_data   , file.compiler_data    ) ;
+    std::swap( this->lazy_reflection , file.lazy_reflection  ) ;
+    std::swap( this->verify_checksums, file.verify_checksums ) ;
 
-    data().map.clear() ;
-    stream.open( path, std::ios::binary ) ;
-
-    if( stream )
-    {
-      magic = data().readMagic( stream ) ;        
-      if( magic != ::nyx::MAGIC ) /*TODO: LOG ERROR HERE */ return ;
+    return *this ;
+  }
 
-      data().version = data().readUnsigned( stream ) ;
-      num_shaders    = data().readUnsigned( stream ) ;
-      num_inputs     = data().readUnsigned( stream ) ;
-      num_outputs    = data().readUnsigned( stream ) ;
-      
-      for( unsigned index = 0; index < num_inputs; index++ )
-      {
-        const std::string name     = data().readString  ( stream ) ;
-        const std::string type     = data().readString  ( stream ) ;
-        const unsigned    size     = data().readUnsigned( stream ) ;
-        const unsigned    location = data().readUnsigned( stream ) ;
-        
-        attr.name     = name     ;
-        attr.type     = type     ;
-        attr.size     = size     ;
-        attr.location = location ;
-        
-        data().inputs.push_back( attr ) ;
-      }
-      
-      for( unsigned index = 0; index < num_outputs; index++ )
-      {
-        const std::string name     = data().readString  ( stream ) ;
-        const std::string type     = data().readString  ( stream ) ;
-        const unsigned    size     = data().readUnsigned( stream ) ;
-        const unsigned    location = data().readUnsigned( stream ) ;
-        
-        attr.name     = name     ;
-        attr.type     = type     ;
-        attr.size     = size     ;
-        attr.location = location ;
-        
-        data().outputs.push_back( attr ) ;
-      }
-      
-      for( unsigned it = 0; it < num_shaders; it++ )
-      {
-        const unsigned  spirv_size     = data().readUnsigned( stream             ) ;
-        const unsigned* spirv          = data().readSpirv   ( stream, spirv_size ) ;
-        const unsigned  stage          = data().readUnsigned( stream             ) ;
-        const unsigned  num_uniforms   = data().readUnsigned( stream             ) ;
+  NyxFileData& NyxFile::reset()
+  {
+    // Copies keep the data as it is, so it is only ever replaced, never loaded over.
+    this->release() ;
+    this->compiler_data = new NyxFileData() ;
 
-        shader.spirv   .clear() ;
-        shader.uniforms.clear() ;
+    data().lazy   = this->lazy_reflection  ;
+    data().verify = this->verify_checksums ;
+    return data() ;
+  }
 
-        shader.spirv     .assign( spirv, spirv + spirv_size ) ;
-        shader.uniforms  .resize( num_uniforms              ) ;
+  void NyxFile::release()
+  {
+    if( this->compiler_data && --this->compiler_data->references == 0 ) delete this->compiler_data ;
 
-        shader.stage = static_cast<::nyx::ShaderStage>( stage ) ;
-        for( unsigned index = 0; index < num_uniforms; index++ )
-        {
-           const std::string name         = data().readString  ( stream ) ;
-           const unsigned uniform_type    = data().readUnsigned( stream ) ;
-           const unsigned uniform_binding = data().readUnsigned( stream ) ;
-           const unsigned uniform_size    = data().readUnsigned( stream ) ;
+    this->compiler_data = nullptr ;
+  }
 
-           uniform.name    = name                                            ;
-           uniform.type    = static_cast<::nyx::UniformType>( uniform_type ) ;
-           uniform.binding = uniform_binding                                 ;
-           uniform.size    = uniform_size                                    ;
+  bool NyxFile::load( const char* path )
+  {
+    const unsigned char* bytes ;
+    unsigned long long   size  ;
 
-           shader.uniforms[ index ] = uniform ;
-        }
-        data().map.insert( { shader.stage, shader } ) ;
-      }
+    // A file that can't be mapped loads as empty.
+    if( !this->map( path ) )
+    {
+      data().error = NyxError::UnableToOpen ;
+      return false ;
     }
+
+    bytes = this->mapping( size ) ;
+    return data().load( bytes, size, true ) ;
   }
   
-  void NyxFile::load( const unsigned char* bytes, unsigned size )
-  {
-    std::stringstream          stream      ;
-    std::string                str         ;
-    unsigned                   num_shaders ;
-    unsigned                   num_inputs  ;
-    unsigned                   num_outputs ;
-    unsigned                   version     ;
-    unsigned long long         magic       ;
-    nyx::Shader                shader      ;
-    nyx::Uniform               uniform     ;
-    nyx::Attribute             attr        ;
-
-    data().map.clear() ;
-    stream.write( reinterpret_cast<const char*>( bytes ), sizeof( unsigned char ) * size ) ;
-
-    magic = data().readMagic( stream ) ;        
-    if( magic != ::nyx::MAGIC ) /*TODO: LOG ERROR HERE */ return ;
-
-    data().version = data().readUnsigned( stream ) ;
-    num_shaders    = data().readUnsigned( stream ) ;
-    num_inputs     = data().readUnsigned( stream ) ;
-    num_outputs    = data().readUnsigned( stream ) ;
-
-    for( unsigned index = 0; index < num_inputs; index++ )
-    {
-      const std::string name     = data().readString  ( stream ) ;
-      const std::string type     = data().readString  ( stream ) ;
-      const unsigned    size     = data().readUnsigned( stream ) ;
-      const unsigned    location = data().readUnsigned( stream ) ;
-
-      attr.name     = name     ;
-      attr.type     = type     ;
-      attr.size     = size     ;
-      attr.location = location ;
-
-      data().inputs.push_back( attr ) ;
-    }
+  bool NyxFile::load( const unsigned char* bytes, unsigned size )
+  {
+    return this->reset().load( bytes, size, false ) ;
+  }
 
-    for( unsigned index = 0; index < num_outputs; index++ )
-    {
-      const std::string name     = data().readString  ( stream ) ;
-      const std::string type     = data().readString  ( stream ) ;
-      const unsigned    size     = data().readUnsigned( stream ) ;
-      const unsigned    location = data().readUnsigned( stream ) ;
+  bool NyxFile::view( const unsigned char* bytes, unsigned size )
+  {
+    return this->reset().load( bytes, size, true ) ;
+  }
 
-      attr.name     = name     ;
-      attr.type     = type     ;
-      attr.size     = size     ;
-      attr.location = location ;
+  bool NyxFile::map( const char* path )
+  {
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>() ;
 
-      data().outputs.push_back( attr ) ;
-    }
+    this->reset() ;
+    if( !file->map( path ) ) return false ;
 
-    for( unsigned it = 0; it < num_shaders; it++ )
-    {
-      const unsigned  spirv_size     = data().readUnsigned( stream             ) ;
-      const unsigned* spirv          = data().readSpirv   ( stream, spirv_size ) ;
-      const unsigned  stage          = data().readUnsigned( stream             ) ;
-      const unsigned  num_uniforms   = data().readUnsigned( stream             ) ;
+    data().file = file ;
+    return true ;
+  }
 
-      shader.spirv   .clear() ;
-      shader.uniforms.clear() ;
+  const unsigned char* NyxFile::mapping( unsigned long long& size ) const
+  {
+    size = data().file ? data().file->size() : 0 ;
+    return data().file ? data().file->bytes() : nullptr ;
+  }
 
-      shader.spirv     .assign( spirv, spirv + spirv_size ) ;
-      shader.uniforms  .resize( num_uniforms              ) ;
+  bool NyxFile::view( const NyxFile& owner, const unsigned char* bytes, unsigned long long size )
+  {
+    std::shared_ptr<MappedFile> file = owner.data().file ;
 
-      shader.stage = static_cast<::nyx::ShaderStage>( stage ) ;
-      for( unsigned index = 0; index < num_uniforms; index++ )
-      {
-         const std::string name         = data().readString  ( stream ) ;
-         const unsigned uniform_type    = data().readUnsigned( stream ) ;
-         const unsigned uniform_binding = data().readUnsigned( stream ) ;
-         const unsigned uniform_size    = data().readUnsigned( stream ) ;
+    this->reset().file = file ;
+    data().archived    = true ;
+    return data().load( bytes, size, true ) ;
+  }
 
-         uniform.name    = name                                            ;
-         uniform.type    = static_cast<::nyx::UniformType>( uniform_type ) ;
-         uniform.binding = uniform_binding                                 ;
-         uniform.size    = uniform_size                                    ;
+  NyxError NyxFile::error() const
+  {
+    return data().error ;
+  }
 
-         shader.uniforms[ index ] = uniform ;
-      }
-      data().map.insert( { shader.stage, shader } ) ;
-    }
+  void NyxFile::setLazyReflection( bool flag )
+  {
+    this->lazy_reflection = flag ;
+  }
+
+  void NyxFile::setVerifyChecksums( bool flag )
+  {
+    this->verify_checksums = flag ;
   }
 
   ShaderIterator NyxFile::begin() const
   {
     ShaderIterator it ;
-    it.data().it = data().map.begin() ;
+    it.file_data   = this->compiler_data ;
+    it.stage_index = data().next( 0 )    ;
+
+    return it ;
+  }
+
+  ShaderIterator NyxFile::find( ShaderStage stage ) const
+  {
+    ShaderIterator it ;
+    it.file_data = this->compiler_data ;
+    if( stage < NUM_STAGES && ( data().present & ( 1u << stage ) ) ) it.stage_index = stage ;
 
     return it ;
   }
@@ -505,72 +1371,127 @@ namespace nyx
   ShaderIterator NyxFile::end() const 
   {
     ShaderIterator it ;
-    it.data().it = data().map.end() ;
+    it.file_data = this->compiler_data ;
 
     return it ;
   }
 
   const char* NyxFile::inputName( unsigned index )
   {
-    if( index < data().inputs.size() ) return data().inputs[ index ].name.c_str() ;
+    data().reflect() ;
+    if( index < data().inputs.size() ) return data().inputs[ index ].name ;
     return "" ;
   }
 
   unsigned NyxFile::inputLocation( unsigned index )
   {
+    data().reflect() ;
     if( index < data().inputs.size() ) return data().inputs[ index ].location ;
     return 0 ;
   }
 
   unsigned NyxFile::inputByteSize( unsigned index )
   {
+    data().reflect() ;
     if( index < data().inputs.size() ) return data().inputs[ index ].size ;
     return 0 ;
   }
 
   const char* NyxFile::inputType( unsigned index )
   {
-    if( index < data().inputs.size() ) return data().inputs[ index ].type.c_str() ;
+    data().reflect() ;
+    if( index < data().inputs.size() ) return data().inputs[ index ].type ;
     return "" ;
   }
 
   const char* NyxFile::outputName( unsigned index )
   {
-    if( index < data().outputs.size() ) return data().outputs[ index ].name.c_str() ;
+    data().reflect() ;
+    if( index < data().outputs.size() ) return data().outputs[ index ].name ;
     return "" ;
   }
 
   unsigned NyxFile::outputLocation( unsigned index )
   {
+    data().reflect() ;
     if( index < data().outputs.size() ) return data().outputs[ index ].location ;
     return 0 ;
   }
 
   unsigned NyxFile::outputByteSize( unsigned index )
   {
+    data().reflect() ;
     if( index < data().outputs.size() ) return data().outputs[ index ].size ;
     return 0 ;
   }
 
   const char* NyxFile::outputType( unsigned index )
   {
-    if( index < data().outputs.size() ) return data().outputs[ index ].type.c_str() ;
+    data().reflect() ;
+    if( index < data().outputs.size() ) return data().outputs[ index ].type ;
     return "" ;
   }
 
+  unsigned NyxFile::inputIndex( const char* name ) const
+  {
+    data().reflect() ;
+    return data().input_table.find( name, data().inputs ) ;
+  }
+
+  unsigned NyxFile::outputIndex( const char* name ) const
+  {
+    data().reflect() ;
+    return data().output_table.find( name, data().outputs ) ;
+  }
+
   unsigned NyxFile::numInputs() const
   {
+    data().reflect() ;
     return data().inputs.size() ;
   }
 
   unsigned NyxFile::numOutputs() const
   {
+    data().reflect() ;
     return data().outputs.size() ;
   }
 
+  const NyxBinding* NyxFile::bindings() const
+  {
+    unsigned count ;
+
+    return data().bindings( count ) ;
+  }
+
+  unsigned NyxFile::numBindings() const
+  {
+    unsigned count ;
+
+    data().bindings( count ) ;
+    return count ;
+  }
+
+  const NyxVertexAttribute* NyxFile::vertexAttributes() const
+  {
+    return data().num_vertex != 0 ? data().vertex_table : nullptr ;
+  }
+
+  unsigned NyxFile::numVertexAttributes() const
+  {
+    return data().num_vertex ;
+  }
+
+  unsigned NyxFile::vertexStride() const
+  {
+    return data().vertex_stride ;
+  }
+
   unsigned NyxFile::size() const
   {
-    return data().map.size() ;
+    unsigned count = 0 ;
+
+    for( unsigned index = data().next( 0 ); index < NUM_STAGES; index = data().next( index + 1 ) ) count++ ;
+    return count ;
   }
 
   NyxFileData& NyxFile::data()
@@ -582,4 +1503,117 @@ namespace nyx
   {
     return *this->compiler_data ;
   }
+
+  // The builder fills in a NyxFileData directly, so it lives alongside it rather than in a file of its own.
+  NyxFileBuilder::NyxFileBuilder()
+  {
+    this->builder_data = new NyxFileData() ;
+    data().clear() ;
+    data().version = NYXFILE_VERSION ;
+  }
+
+  NyxFileBuilder::~NyxFileBuilder()
+  {
+    delete this->builder_data ;
+  }
+
+  void NyxFileBuilder::addStage( ShaderStage stage, std::vector<unsigned>&& spirv )
+  {
+    Shader* shader = data().shader( stage ) ;
+
+    if( shader )
+    {
+      shader->spirv      = std::move( spirv )   ;
+      shader->spirv_size = shader->spirv.size() ;
+      shader->mapped     = nullptr              ;
+      shader->strings    = data().strings       ;
+    }
+  }
+
+  void NyxFileBuilder::addUniform( ShaderStage stage, std::string&& name, UniformType type, unsigned binding, unsigned size )
+  {
+    Shader*      shader = data().shader( stage ) ;
+    nyx::Uniform uniform                         ;
+
+    if( !shader ) return ;
+
+    // The arena never moves its strings, so the uniform can point at its name for as long as the file lives.
+    data().strings.owned->strings.push_back( std::move( name ) ) ;
+
+    uniform.name    = data().strings.owned->strings.back().c_str() ;
+    uniform.type    = type                                         ;
+    uniform.binding = binding                                      ;
+    uniform.size    = size                                         ;
+
+    shader->uniforms.push_back( uniform ) ;
+  }
+
+  void NyxFileBuilder::addInput( std::string&& name, std::string&& type, unsigned size, unsigned location )
+  {
+    nyx::Attribute attr ;
+
+    data().strings.owned->strings.push_back( std::move( name ) ) ;
+    attr.name = data().strings.owned->strings.back().c_str() ;
+    data().strings.owned->strings.push_back( std::move( type ) ) ;
+    attr.type = data().strings.owned->strings.back().c_str() ;
+
+    attr.size     = size     ;
+    attr.location = location ;
+    data().inputs.push_back( attr ) ;
+  }
+
+  void NyxFileBuilder::addOutput( std::string&& name, std::string&& type, unsigned size, unsigned location )
+  {
+    nyx::Attribute attr ;
+
+    data().strings.owned->strings.push_back( std::move( name ) ) ;
+    attr.name = data().strings.owned->strings.back().c_str() ;
+    data().strings.owned->strings.push_back( std::move( type ) ) ;
+    attr.type = data().strings.owned->strings.back().c_str() ;
+
+    attr.size     = size     ;
+    attr.location = location ;
+    data().outputs.push_back( attr ) ;
+  }
+
+  void NyxFileBuilder::setBindings( std::vector<NyxBinding>&& bindings )
+  {
+    data().owned_bindings = std::move( bindings )        ;
+    data().binding_table  = data().owned_bindings.data() ;
+    data().num_bindings   = data().owned_bindings.size() ;
+    data().has_bindings   = true                         ;
+  }
+
+  void NyxFileBuilder::setVertexInput( std::vector<NyxVertexAttribute>&& attributes, unsigned stride )
+  {
+    data().owned_vertex  = std::move( attributes )    ;
+    data().vertex_table  = data().owned_vertex.data() ;
+    data().num_vertex    = data().owned_vertex.size() ;
+    data().vertex_stride = stride                     ;
+  }
+
+  void NyxFileBuilder::build( NyxFile& file )
+  {
+    NyxFileData* built = this->builder_data ;
+
+    this->builder_data = new NyxFileData() ;
+    data().clear() ;
+    data().version = NYXFILE_VERSION ;
+
+    // Copies of the file keep the data they share with it, exactly as when loading into it.
+    file.release() ;
+    file.compiler_data = built                 ;
+    built->lazy        = file.lazy_reflection  ;
+    built->verify      = file.verify_checksums ;
+  }
+
+  NyxFileData& NyxFileBuilder::data()
+  {
+    return *this->builder_data ;
+  }
+
+  const NyxFileData& NyxFileBuilder::data() const
+  {
+    return *this->builder_data ;
+  }
 }
\ No newline at end of file
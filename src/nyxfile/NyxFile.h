@@ -19,7 +19,9 @@
 
 namespace nyx
 {
-  class NyxFile ;
+  class NyxFile        ;
+  class NyxArchive     ;
+  class NyxFileBuilder ;
   
   /** The Shader stages possible for a KgFile to contain.
    */
@@ -44,7 +46,79 @@ namespace nyx
     SSBO
   };
 
+  /** A binding of a pipeline's descriptor sets, merged across every shader stage using it.
+   * This is exactly how bindings are stored in a .nyx file, so a table of them can be read in place.
+   */
+  struct NyxBinding
+  {
+    unsigned set     ; ///< The descriptor set the binding is in.
+    unsigned binding ; ///< The index of the binding in its set.
+    unsigned type    ; ///< The UniformType of the binding.
+    unsigned count   ; ///< The amount of descriptors in the binding.
+    unsigned stages  ; ///< The mask of shader stages using the binding, with bit ( 1 << ShaderStage ) set for each one.
+  };
+
+  /** The formats of vertex attributes.
+   * Each one has the value of the matching VkFormat, so they can be handed to Vulkan as they are.
+   */
+  enum VertexFormat : unsigned
+  {
+    Undefined           = 0,
+    R32_Uint            = 98,
+    R32_Sint            = 99,
+    R32_Sfloat          = 100,
+    R32G32_Uint         = 101,
+    R32G32_Sint         = 102,
+    R32G32_Sfloat       = 103,
+    R32G32B32_Uint      = 104,
+    R32G32B32_Sint      = 105,
+    R32G32B32_Sfloat    = 106,
+    R32G32B32A32_Uint   = 107,
+    R32G32B32A32_Sint   = 108,
+    R32G32B32A32_Sfloat = 109,
+    R64_Sfloat          = 112,
+    R64G64_Sfloat       = 115,
+    R64G64B64_Sfloat    = 118,
+    R64G64B64A64_Sfloat = 121,
+  };
+
+  /** An attribute of a pipeline's vertex input, with every attribute interleaved into a single vertex buffer binding.
+   * This is exactly how attributes are stored in a .nyx file, and is laid out like a VkVertexInputAttributeDescription.
+   */
+  struct NyxVertexAttribute
+  {
+    unsigned location ; ///< The shader location of the attribute.
+    unsigned binding  ; ///< The vertex buffer binding the attribute is read from, always 0.
+    unsigned format   ; ///< The VertexFormat of the attribute.
+    unsigned offset   ; ///< The offset in bytes of the attribute from the start of a vertex.
+  };
+
+  /** The reasons a .nyx file can fail to load.
+   */
+  enum NyxError : unsigned
+  {
+    NoError,            ///< The file loaded.
+    UnableToOpen,       ///< The file could not be opened or mapped.
+    BadMagic,           ///< The data does not start with the .nyx magic number.
+    UnsupportedVersion, ///< The file's version is not one this library can read.
+    TruncatedFile,      ///< The header, the section table or a version 1 file ends before its contents do.
+    TruncatedSection,   ///< A section reaches past the end of the file.
+    MisalignedSection,  ///< A section does not start on the alignment its file promises.
+    CountOverflow,      ///< A count claims more items than the bytes holding them can contain.
+    CorruptSpirv,       ///< Compressed SPIRV could not be decoded.
+    ChecksumMismatch,   ///< A section does not match its checksum.
+    BadHeader,          ///< The header's reserved field is set, or its file size says the data has bytes that aren't part of the file.
+    BadStringPool,      ///< The file's names are pooled, but its string section is missing, empty or not terminated.
+  };
+
+  /** Method to retrieve a description of a load error.
+   * @param error The error to describe.
+   * @return The C-string description of the error.
+   */
+  const char* errorString( NyxError error ) ;
+
   /** Iterator class to iterate over all shader data.
+   * Iterators are a position into their NyxFile's stages, so creating & copying them never allocates.
    */
   class ShaderIterator
   {
@@ -58,6 +132,11 @@ namespace nyx
        */
       ShaderIterator( const ShaderIterator& input ) ;
 
+      /** Move constructor. Assigns this object to the input.
+       * @param input The object to assign this one to.
+       */
+      ShaderIterator( ShaderIterator&& input ) ;
+
       /** Default Desconstructor.
        */
       ~ShaderIterator() ;
@@ -102,7 +181,8 @@ namespace nyx
       const char* attributeType( unsigned index ) ;
 
       /** Method to retrieve the full compiled spirv for this shader.
-       * @return The compiled spirv representation of the current shader stage.
+       * Compressed spirv is decoded into memory owned by the file the first time this is called.
+       * @return The compiled spirv representation of the current shader stage, or nullptr if it could not be decoded.
        */
       const unsigned* spirv() const ;
 
@@ -110,6 +190,13 @@ namespace nyx
        * @return The size of the compiled spirv of this shader stage.
        */
       unsigned spirvSize() const ;
+
+      /** Method to write the compiled spirv of this shader into a buffer.
+       * Compressed spirv is decoded straight into the buffer, without being kept around by the file.
+       * @param words The buffer to write the spirv into, which must hold at least spirvSize() words.
+       * @return Whether or not the spirv could be decoded.
+       */
+      bool decodeSpirv( unsigned* words ) const ;
       
       /** Overloaded * operator to allow range-based for loops.
        * @return The shader stage of this iterator.
@@ -145,6 +232,12 @@ namespace nyx
        */
       const char* uniformName( unsigned id ) const ;
 
+      /** Method to look up the index of a uniform by its name, in constant time.
+       * @param name The C-string name of the uniform to look up.
+       * @return The index of the uniform with that name, or UINT_MAX if this shader stage has none.
+       */
+      unsigned uniformIndex( const char* name ) const ;
+
       /** ++ Operator to allow iteration of this object in a loop.
        */
       void operator++() ;
@@ -155,6 +248,12 @@ namespace nyx
        */
       ShaderIterator& operator=( const ShaderIterator& input ) ;
 
+      /** Move assignment operator. Assigns this object to the input.
+       * @param input The object to assign this object to.
+       * @return Reference to this object after assignment.
+       */
+      ShaderIterator& operator=( ShaderIterator&& input ) ;
+
       /** Inequality operator to use for comparison to allow iterating over this object.
        * @param input The object to test this object against.
        * @return Whether or not this object is equal to the input.
@@ -163,19 +262,18 @@ namespace nyx
 
     private:
 
-      /** Forward declared structure containing this object's data.
+      /** Forward declared structure containing the data of the file this object iterates over.
        */
-      struct ShaderIteratorData *shader_iterator_data ;
+      const struct NyxFileData* file_data ;
 
-      /** Method to retrieve a reference to this object's internal data structure.
-       * @return Reference to this object's internal data structure.
+      /** The index of the shader stage this object is positioned at.
        */
-      ShaderIteratorData& data() ;
+      unsigned stage_index ;
 
-      /** Method to retrieve a const-reference to this object's internal data structure.
-       * @return Const-reference to this object's internal data structure.
+      /** Method to retrieve a const-reference to the internal data structure of the file this object iterates over.
+       * @return Const-reference to the file's internal data structure.
        */
-      const ShaderIteratorData& data() const  ;
+      const NyxFileData& data() const  ;
 
       /** Forward declare friendship.
        */
@@ -183,6 +281,9 @@ namespace nyx
   };
 
   /** Class to abstract a KgFile.
+   * Loaded data is never modified, and is shared between copies of an object instead of being duplicated. Copying is
+   * constant time, and any number of threads can read copies of the same file at once. Loading into an object only
+   * replaces what that object holds, never what its copies do.
    */
   class NyxFile
   {
@@ -192,25 +293,76 @@ namespace nyx
        */
       NyxFile() ;
 
+      /** Copy constructor. Shares the input's data with this object.
+       * @param file The object to share the data of.
+       */
+      NyxFile( const NyxFile& file ) ;
+
+      /** Move constructor. Takes over the input's data.
+       * The input is left empty, and can still be used & loaded into as usual.
+       * @param file The object to take the data of.
+       */
+      NyxFile( NyxFile&& file ) ;
+
       /** Default deconstructor.
        */
       ~NyxFile() ;
       
-      /** Assignment operator. Assigns the input to this object.
+      /** Assignment operator. Shares the input's data with this object.
        * @param file The object to assign this one to.
        * @return Reference to this object after assignment.
        */
       NyxFile& operator=( const NyxFile& file ) ;
+
+      /** Move assignment operator. Swaps the data of this object with the input's.
+       * @param file The object to take the data of.
+       * @return Reference to this object after assignment.
+       */
+      NyxFile& operator=( NyxFile&& file ) ;
       
       /** Method to load the specified .nyx file at the input path.
+       * The file is memory mapped for as long as this object holds it, and SPIRV is handed out directly from the mapping.
        * @param The C-string path of the file on the filesystem to load.
+       * @return Whether or not the file could be opened and is a valid .nyx file. If not, this object is left empty.
        */
-      void load( const char* path ) ;
+      bool load( const char* path ) ;
       
-      /** Method to load the specified .nyx file at the input path.
+      /** Method to load a .nyx file from memory.
+       * The bytes are decoded in place, and only the SPIRV is copied out of them.
        * @param The array of bytes containing the .nyx file's data.
+       * @param size The amount of bytes in the array.
+       * @return Whether or not the bytes are a valid .nyx file.
+       */
+      bool load( const unsigned char* bytes, unsigned size ) ;
+
+      /** Method to load a .nyx file from memory without copying any of it.
+       * SPIRV is handed out directly from the bytes, so they must outlive this object's use of them.
+       * This is meant for data that lives forever anyways, like the arrays generated with nyxmaker -h.
+       * @param The array of bytes containing the .nyx file's data.
+       * @param size The amount of bytes in the array.
+       * @return Whether or not the bytes are a valid .nyx file.
+       */
+      bool view( const unsigned char* bytes, unsigned size ) ;
+
+      /** Method to retrieve why the last load or view of this object failed.
+       * Everything a file claims to contain is checked against the bytes it actually has before anything is allocated
+       * for it, so a bad file is rejected right away instead of being read as garbage.
+       * @return The error the last load failed with, or NoError if it didn't.
+       */
+      NyxError error() const ;
+
+      /** Method to set whether reflection data is only decoded once it is first asked for.
+       * This applies to files loaded by path or through view(), and must be set before loading.
+       * @param flag Whether or not to defer decoding the uniforms, inputs & outputs of loaded files.
+       */
+      void setLazyReflection( bool flag ) ;
+
+      /** Method to set whether the checksums of a file are checked before anything in it is decoded.
+       * Files that fail the check don't load, and neither do version 2 files saved without checksums.
+       * This must be set before loading.
+       * @param flag Whether or not to check every section of loaded files against their checksums.
        */
-      void load( const unsigned char* bytes, unsigned size ) ;
+      void setVerifyChecksums( bool flag ) ;
 
       /** Method to retrieve an iterator at the beginning of this object.
        * @return Iterator starting at the beginning of this object.
@@ -222,6 +374,12 @@ namespace nyx
        */
       ShaderIterator end() const ;
 
+      /** Method to retrieve an iterator positioned at the specified shader stage.
+       * @param stage The shader stage to look up.
+       * @return Iterator at the shader stage, or end() if this object does not contain it.
+       */
+      ShaderIterator find( ShaderStage stage ) const ;
+
       /** Method to retrieve the number of shaders in this object.
        */
       unsigned size() const ;
@@ -274,6 +432,18 @@ namespace nyx
        */
       const char* outputType( unsigned index ) ;
 
+      /** Method to look up the index of an input by its name, in constant time.
+       * @param name The C-string name of the input to look up.
+       * @return The index of the input with that name, or UINT_MAX if there is none.
+       */
+      unsigned inputIndex( const char* name ) const ;
+
+      /** Method to look up the index of an output by its name, in constant time.
+       * @param name The C-string name of the output to look up.
+       * @return The index of the output with that name, or UINT_MAX if there is none.
+       */
+      unsigned outputIndex( const char* name ) const ;
+
       /** Method to retrieve the number of attributes in this shader stage.
        * @return The number of attributes in this shader stage.
        */
@@ -283,12 +453,72 @@ namespace nyx
        * @return The number of attributes in this shader stage.
        */
       unsigned numOutputs() const ;
+
+      /** Method to retrieve the descriptor bindings of every shader stage in this object, merged into one table.
+       * Bindings used by several stages appear once, with every one of those stages in their mask.
+       * @return Pointer to numBindings() bindings sorted by set & then by binding, or nullptr if there are none.
+       */
+      const NyxBinding* bindings() const ;
+
+      /** Method to retrieve the number of descriptor bindings in this object.
+       * @return The number of merged descriptor bindings of every shader stage in this object.
+       */
+      unsigned numBindings() const ;
+
+      /** Method to retrieve the vertex input layout of this object's vertex stage, ready to create a pipeline with.
+       * Matrices & arrays take one attribute per location they cover. Files saved without a layout have none.
+       * @return Pointer to numVertexAttributes() attributes sorted by location, or nullptr if there are none.
+       */
+      const NyxVertexAttribute* vertexAttributes() const ;
+
+      /** Method to retrieve the number of vertex attributes in this object.
+       * @return The number of attributes in this object's vertex input layout.
+       */
+      unsigned numVertexAttributes() const ;
+
+      /** Method to retrieve the size of a single vertex, with every vertex attribute interleaved.
+       * @return The stride in bytes between the vertices of this object's vertex input layout.
+       */
+      unsigned vertexStride() const ;
     private:
 
-      /** Forward declared structure containing this object's data.
+      /** Forward declared structure containing this object's data, shared with every copy of this object.
        */
       struct NyxFileData* compiler_data ;
 
+      bool lazy_reflection  ; ///< Whether the next load defers decoding reflection data.
+      bool verify_checksums ; ///< Whether the next load checks the file's checksums.
+
+      /** Method to replace this object's data with empty data of its own, ready to load into.
+       * Copies of this object keep the data they share with it.
+       * @return Reference to this object's new data.
+       */
+      NyxFileData& reset() ;
+
+      /** Method to stop sharing this object's data, deleting it if this object was the last one holding it.
+       */
+      void release() ;
+
+      /** Method to memory map the file at the input path, without decoding it.
+       * @param path The C-string path of the file on the filesystem to map.
+       * @return Whether or not the file was able to be mapped.
+       */
+      bool map( const char* path ) ;
+
+      /** Method to retrieve the bytes this object has mapped.
+       * @param size Set to the amount of mapped bytes.
+       * @return Pointer to the first mapped byte, or nullptr if nothing is mapped.
+       */
+      const unsigned char* mapping( unsigned long long& size ) const ;
+
+      /** Method to view a .nyx file that lives inside of another object's mapping, keeping that mapping alive.
+       * @param owner The object that has the bytes mapped.
+       * @param bytes The first byte of the .nyx file's data.
+       * @param size The amount of bytes in the .nyx file's data.
+       * @return Whether or not the bytes are a valid .nyx file.
+       */
+      bool view( const NyxFile& owner, const unsigned char* bytes, unsigned long long size ) ;
+
       /** Method to retrieve a reference to this object's internal data structure.
        * @return Reference to this object's internal data structure.
        */
@@ -298,5 +528,10 @@ namespace nyx
        * @return Const-reference to this object's internal data structure.
        */
       const NyxFileData& data() const ;
+
+      /** Forward declare friendship.
+       */
+      friend class NyxArchive     ;
+      friend class NyxFileBuilder ;
   };
 }
\ No newline at end of file
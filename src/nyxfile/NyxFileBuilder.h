@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+
+namespace nyx
+{
+  class  NyxFile            ;
+  struct NyxBinding         ;
+  struct NyxVertexAttribute ;
+  enum   ShaderStage : unsigned ;
+  enum   UniformType : unsigned ;
+
+  /** Class to put together a NyxFile in memory, out of data that was never saved as a .nyx file.
+   * Everything is taken over by moving it into the file, so building one costs no more than the file's own bookkeeping.
+   * The built file behaves exactly as if the same data had been saved & loaded back.
+   */
+  class NyxFileBuilder
+  {
+    public:
+
+      /** Default constructor.
+       */
+      NyxFileBuilder() ;
+
+      /** Default deconstructor. Releases whatever was added but never built into a file.
+       */
+      ~NyxFileBuilder() ;
+
+      /** Method to add a shader stage, taking over its SPIRV.
+       * @param stage The stage of the shader.
+       * @param spirv The SPIRV words of the shader, which are moved into the file.
+       */
+      void addStage( ShaderStage stage, std::vector<unsigned>&& spirv ) ;
+
+      /** Method to add a uniform to a shader stage, in the order they are to be indexed by.
+       * @param stage The stage of the shader the uniform belongs to.
+       * @param name The name of the uniform, which is moved into the file.
+       * @param type The type of the uniform.
+       * @param binding The binding of the uniform.
+       * @param size The size of the uniform.
+       */
+      void addUniform( ShaderStage stage, std::string&& name, UniformType type, unsigned binding, unsigned size ) ;
+
+      /** Method to add an input of the pipeline, in the order they are to be indexed by.
+       * @param name The name of the input, which is moved into the file.
+       * @param type The GLSL type name of the input, which is moved into the file.
+       * @param size The size in bytes of the input.
+       * @param location The location of the input.
+       */
+      void addInput( std::string&& name, std::string&& type, unsigned size, unsigned location ) ;
+
+      /** Method to add an output of the pipeline, in the order they are to be indexed by.
+       * @param name The name of the output, which is moved into the file.
+       * @param type The GLSL type name of the output, which is moved into the file.
+       * @param size The size in bytes of the output.
+       * @param location The location of the output.
+       */
+      void addOutput( std::string&& name, std::string&& type, unsigned size, unsigned location ) ;
+
+      /** Method to set the merged descriptor bindings of every stage. Without them, they are merged out of the uniforms.
+       * @param bindings The bindings sorted by set & then by binding, which are moved into the file.
+       */
+      void setBindings( std::vector<NyxBinding>&& bindings ) ;
+
+      /** Method to set the vertex input layout of the vertex stage.
+       * @param attributes The attributes sorted by location, which are moved into the file.
+       * @param stride The size in bytes of a single interleaved vertex.
+       */
+      void setVertexInput( std::vector<NyxVertexAttribute>&& attributes, unsigned stride ) ;
+
+      /** Method to hand everything added so far over to a file, replacing whatever it held.
+       * Copies of the file keep what they shared with it. This object is left empty, ready to build another file.
+       * @param file The file to build.
+       */
+      void build( NyxFile& file ) ;
+
+    private:
+
+      /** Builders own what they are given, and so cannot be copied.
+       */
+      NyxFileBuilder( const NyxFileBuilder& orig ) ;
+      NyxFileBuilder& operator=( const NyxFileBuilder& orig ) ;
+
+      /** Forward declared structure containing the data of the file being built.
+       */
+      struct NyxFileData* builder_data ;
+
+      /** Method to retrieve a reference to the data of the file being built.
+       * @return Reference to the data of the file being built.
+       */
+      NyxFileData& data() ;
+
+      /** Method to retrieve a const-reference to the data of the file being built.
+       * @return Const-reference to the data of the file being built.
+       */
+      const NyxFileData& data() const ;
+  };
+}
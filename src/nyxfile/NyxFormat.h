@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "NyxFile.h"
+#include "Crc32c.h"
+#include <cstddef>
+
+/* On-disk layout of a .nyx file, shared by the writer and the reader.
+ *
+ * Version 1 is purely sequential:
+ *   magic, version, num_shaders, num_inputs, num_outputs, inputs, outputs,
+ *   then per shader: spirv_size, spirv, stage, num_uniforms, uniforms.
+ *
+ * Version 2 starts with a fixed size NyxHeader, followed by num_sections NyxSection entries.
+ * Every section is addressed by its offset from the start of the file, so any single stage can be
+ * reached without decoding anything in front of it:
+ *   PipelineSection        : num_inputs, num_outputs, inputs, outputs.
+ *   SpirvSection           : The raw SPIRV words of one stage.
+ *   ReflectionSection      : num_uniforms, uniforms of one stage.
+ *   StringSection          : Every distinct string of the file, each followed by a terminator. Never empty, as it
+ *                            holds at least a terminator even when the file has no strings.
+ *   UniformHashSection     : num_buckets, 0, then the NyxNameBuckets looking up one stage's uniforms by name.
+ *   InputHashSection       : Likewise, for the pipeline's inputs.
+ *   OutputHashSection      : Likewise, for the pipeline's outputs.
+ *   CompressedSpirvSection : The amount of SPIRV words of one stage, then those words as encoded by encodeSpirv().
+ *                            Takes the place of the stage's SpirvSection.
+ *   BindingSection         : num_bindings, 0, then the NyxBindings of every stage, merged & sorted by set and binding.
+ *   VertexInputSection     : num_attributes, stride, then the NyxVertexAttributes of the vertex stage sorted by location.
+ *   ChecksumSection        : The crc32c() of every section, in the order of the section table. The entry of the
+ *                            ChecksumSection itself is the tableChecksum() of the file. Present when the header
+ *                            has the Checksummed flag, though a verifying reader requires it regardless.
+ *
+ * Strings are a 4 byte length followed by that many characters. When the header has the PooledStrings flag
+ * they are instead a 4 byte offset into the StringSection, which lets names shared between stages be stored
+ * once and read in place. All values are little endian.
+ *
+ * When the header has the AlignedSections flag, every section starts on a SECTION_ALIGNMENT boundary
+ * from the start of the file and is zero padded up to the next one. The SPIRV of a stage can then be
+ * read as words straight out of any suitably aligned copy of the file, without being copied first.
+ *
+ * An archive ( .nyxa ) packs many .nyx files into one. It starts with a NyxArchiveHeader, followed by
+ * num_entries NyxArchiveEntry entries sorted by name, then every entry's .nyx file on a SECTION_ALIGNMENT
+ * boundary, then the SPIRV shared between them, then the names of the entries, each followed by a terminator.
+ * Section offsets of a .nyx file inside of an archive are relative to its own start. Its SpirvSections point
+ * past its end into the shared SPIRV, which holds every distinct SPIRV of the archive only once.
+ */
+namespace nyx
+{
+  constexpr unsigned long long MAGIC             = 0x555755200d0a ;
+  constexpr unsigned           NYXFILE_VERSION   = 2              ;
+  constexpr unsigned           SECTION_ALIGNMENT = 16             ;
+  constexpr unsigned long long ARCHIVE_MAGIC     = 0x415755200d0a ;
+  constexpr unsigned           ARCHIVE_VERSION   = 1              ;
+
+  /** The types of sections a version 2 .nyx file can contain.
+   */
+  enum SectionType : unsigned
+  {
+    PipelineSection        = 0,
+    SpirvSection           = 1,
+    ReflectionSection      = 2,
+    StringSection          = 3,
+    UniformHashSection     = 4,
+    InputHashSection       = 5,
+    OutputHashSection      = 6,
+    CompressedSpirvSection = 7,
+    ChecksumSection        = 8,
+    BindingSection         = 9,
+    VertexInputSection     = 10,
+  };
+
+  /** The flags a version 2 .nyx file's header can have set.
+   */
+  enum HeaderFlags : unsigned
+  {
+    AlignedSections = 0x1,
+    PooledStrings   = 0x2,
+    Checksummed     = 0x4,
+  };
+
+  /** The fixed size header at the start of a version 2 .nyx file.
+   */
+  struct NyxHeader
+  {
+    unsigned long long magic        ; ///< Always MAGIC.
+    unsigned           version      ; ///< The version of the file's layout.
+    unsigned           flags        ; ///< The HeaderFlags of the file.
+    unsigned           num_shaders  ; ///< The amount of shader stages in the file.
+    unsigned           num_sections ; ///< The amount of NyxSection entries following this header.
+    unsigned           file_size    ; ///< The total size of the file in bytes.
+    unsigned           reserved     ; ///< Reserved, always 0.
+  };
+
+  /** An entry of the section table of a version 2 .nyx file.
+   */
+  struct NyxSection
+  {
+    unsigned type   ; ///< The SectionType of this section.
+    unsigned stage  ; ///< The ShaderStage this section belongs to, if it is per-stage.
+    unsigned offset ; ///< The offset in bytes of this section from the start of the file.
+    unsigned size   ; ///< The size in bytes of this section.
+  };
+
+  /** The fixed size header at the start of a .nyxa archive.
+   */
+  struct NyxArchiveHeader
+  {
+    unsigned long long magic        ; ///< Always ARCHIVE_MAGIC.
+    unsigned           version      ; ///< The version of the archive's layout.
+    unsigned           num_entries  ; ///< The amount of NyxArchiveEntry entries following this header.
+    unsigned           names_offset ; ///< The offset in bytes of the entries' names from the start of the archive.
+    unsigned           names_size   ; ///< The size in bytes of the entries' names.
+    unsigned           file_size    ; ///< The total size of the archive in bytes.
+    unsigned           reserved     ; ///< Reserved, always 0.
+  };
+
+  /** An entry of the directory of a .nyxa archive.
+   */
+  struct NyxArchiveEntry
+  {
+    unsigned name   ; ///< The offset of this entry's name into the archive's names.
+    unsigned flags  ; ///< Reserved, always 0.
+    unsigned offset ; ///< The offset in bytes of this entry's .nyx file from the start of the archive.
+    unsigned size   ; ///< The size in bytes of this entry's .nyx file.
+  };
+
+  /** A bucket of a name lookup table.
+   * Tables are open addressed with linear probing, and have a power of two amount of buckets that is at least
+   * twice the amount of names in them, so there is always an empty bucket to end a probe on.
+   */
+  struct NyxNameBucket
+  {
+    unsigned hash  ; ///< The hashName() of the name in this bucket.
+    unsigned index ; ///< One past the index of the name in its list, or 0 if this bucket is empty.
+  };
+
+  /** Method to hash a name for a name lookup table ( 32 bit FNV-1a ).
+   * @param name The C-string to hash.
+   * @return The hash of the name.
+   */
+  inline unsigned hashName( const char* name )
+  {
+    unsigned hash = 2166136261u ;
+
+    for( const char* ch = name; *ch; ++ch )
+    {
+      hash ^= static_cast<unsigned char>( *ch ) ;
+      hash *= 16777619u                         ;
+    }
+
+    return hash ;
+  }
+
+  /** Method to retrieve the amount of buckets a name lookup table needs.
+   * @param count The amount of names the table will contain.
+   * @return The amount of buckets of the table.
+   */
+  inline unsigned nameBuckets( unsigned count )
+  {
+    unsigned buckets = 1 ;
+
+    while( buckets < count * 2 ) buckets <<= 1 ;
+    return buckets ;
+  }
+
+  /** Method to insert a name into a name lookup table.
+   * @param buckets The zero initialized buckets of the table.
+   * @param num_buckets The amount of buckets of the table.
+   * @param hash The hashName() of the name to insert.
+   * @param index The index of the name in its list.
+   */
+  inline void insertName( NyxNameBucket* buckets, unsigned num_buckets, unsigned hash, unsigned index )
+  {
+    unsigned bucket = hash & ( num_buckets - 1 ) ;
+
+    while( buckets[ bucket ].index != 0 ) bucket = ( bucket + 1 ) & ( num_buckets - 1 ) ;
+
+    buckets[ bucket ].hash  = hash      ;
+    buckets[ bucket ].index = index + 1 ;
+  }
+
+  /** Method to compute the checksum of a version 2 .nyx file's header and section table.
+   * Offsets and the file's size are left out, as archiving a file moves its sections around. A corrupted offset
+   * still shows, as the section it points to no longer matches its own checksum.
+   * @param header The header of the file.
+   * @param sections The section table of the file.
+   * @param count The amount of sections in the table.
+   * @return The checksum of the header and the section table.
+   */
+  inline unsigned tableChecksum( const NyxHeader& header, const NyxSection* sections, unsigned count )
+  {
+    unsigned crc = crc32c( reinterpret_cast<const unsigned char*>( &header ), offsetof( NyxHeader, file_size ) ) ;
+
+    for( unsigned index = 0; index < count; index++ )
+    {
+      crc = crc32c( reinterpret_cast<const unsigned char*>( &sections[ index ].type ), sizeof( unsigned ) * 2, crc ) ;
+      crc = crc32c( reinterpret_cast<const unsigned char*>( &sections[ index ].size ), sizeof( unsigned )    , crc ) ;
+    }
+
+    return crc ;
+  }
+
+  static_assert( sizeof( NyxHeader  ) == 32, "The .nyx header must stay 32 bytes."      ) ;
+  static_assert( sizeof( NyxSection ) == 16, "A .nyx section entry must stay 16 bytes." ) ;
+
+  static_assert( sizeof( NyxBinding         ) == 20, "A .nyx binding must stay 20 bytes."          ) ;
+  static_assert( sizeof( NyxVertexAttribute ) == 16, "A .nyx vertex attribute must stay 16 bytes." ) ;
+
+  static_assert( sizeof( NyxArchiveHeader ) == 32, "The .nyxa header must stay 32 bytes."         ) ;
+  static_assert( sizeof( NyxArchiveEntry  ) == 16, "A .nyxa directory entry must stay 16 bytes." ) ;
+
+  static_assert( sizeof( NyxHeader  ) % SECTION_ALIGNMENT == 0, "The first section must start aligned." ) ;
+  static_assert( sizeof( NyxSection ) % SECTION_ALIGNMENT == 0, "The first section must start aligned." ) ;
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NyxLibrary.h"
+#include "NyxFile.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <filesystem>
+#include <string.h>
+
+namespace nyx
+{
+  /** Structure containing the data of a library.
+   */
+  struct NyxLibraryData
+  {
+    /** Structure to encompass a single file of the library.
+     */
+    struct Entry
+    {
+      std::string name ; ///< The name of the file, without its extension.
+      std::string path ; ///< The path of the file on the filesystem.
+      NyxFile     file ; ///< The loaded file, which knows why it failed to load if it did.
+    };
+
+    std::vector<Entry> entries         ; ///< The files of the library, sorted by name.
+    unsigned           threads = 0     ; ///< The amount of threads to load with, or 0 for one per hardware thread.
+    bool               lazy    = false ; ///< Whether reflection decoding is deferred until it is first used.
+    bool               verify  = false ; ///< Whether the checksums of loaded files are checked.
+
+    /** Method to replace the library's files with the files at the input paths, without loading them yet.
+     * @param paths The paths of the files on the filesystem.
+     */
+    void assign( const std::vector<std::string>& paths ) ;
+
+    /** Method to load every file of the library, spread over the worker threads.
+     * @return Whether or not every file was loaded.
+     */
+    bool loadAll() ;
+
+    /** Method to load a single file of the library.
+     * @param entry The file to load.
+     */
+    void loadEntry( Entry& entry ) const ;
+  };
+
+  void NyxLibraryData::assign( const std::vector<std::string>& paths )
+  {
+    std::vector<std::pair<std::string, std::string>> named ;
+
+    for( const auto& path : paths ) named.push_back( { std::filesystem::path( path ).stem().string(), path } ) ;
+
+    // Paths are sorted up front, so the files never have to be moved around after they are loaded.
+    std::stable_sort( named.begin(), named.end(), []( const auto& lhs, const auto& rhs ) { return lhs.first < rhs.first ; } ) ;
+
+    this->entries = std::vector<Entry>( named.size() ) ;
+    for( unsigned index = 0; index < named.size(); index++ )
+    {
+      this->entries[ index ].name = named[ index ].first  ;
+      this->entries[ index ].path = named[ index ].second ;
+    }
+  }
+
+  bool NyxLibraryData::loadAll()
+  {
+    std::vector<std::thread> workers   ;
+    std::atomic<unsigned>    next( 0 ) ;
+    unsigned                 count     ;
+
+    // Every thread, the calling one included, keeps taking the next file until there are none left.
+    auto work = [ this, &next ]()
+    {
+      for( unsigned index = next++; index < this->entries.size(); index = next++ ) this->loadEntry( this->entries[ index ] ) ;
+    };
+
+    count = this->threads ? this->threads : std::thread::hardware_concurrency() ;
+    count = std::max( 1u, std::min<unsigned>( count, this->entries.size() ) ) ;
+    for( unsigned index = 1; index < count; index++ ) workers.emplace_back( work ) ;
+
+    work() ;
+    for( auto& worker : workers ) worker.join() ;
+
+    return std::none_of( this->entries.begin(), this->entries.end(), []( const Entry& entry ) { return entry.file.error() != NyxError::NoError ; } ) ;
+  }
+
+  void NyxLibraryData::loadEntry( Entry& entry ) const
+  {
+    entry.file.setLazyReflection( this->lazy   ) ;
+    entry.file.setVerifyChecksums( this->verify ) ;
+    entry.file.load( entry.path.c_str() ) ;
+  }
+
+  NyxLibrary::NyxLibrary()
+  {
+    this->library_data = new NyxLibraryData() ;
+  }
+
+  NyxLibrary::~NyxLibrary()
+  {
+    delete this->library_data ;
+  }
+
+  void NyxLibrary::setThreadCount( unsigned count )
+  {
+    data().threads = count ;
+  }
+
+  void NyxLibrary::setLazyReflection( bool flag )
+  {
+    data().lazy = flag ;
+  }
+
+  void NyxLibrary::setVerifyChecksums( bool flag )
+  {
+    data().verify = flag ;
+  }
+
+  bool NyxLibrary::load( const char* directory )
+  {
+    std::vector<std::string> paths ;
+    std::error_code          error ;
+
+    for( std::filesystem::directory_iterator iter( directory, error ), end; !error && iter != end; iter.increment( error ) )
+    {
+      if( iter->path().extension() == ".nyx" ) paths.push_back( iter->path().string() ) ;
+    }
+
+    data().assign( paths ) ;
+    return data().loadAll() && !error ;
+  }
+
+  bool NyxLibrary::load( const char* const* paths, unsigned count )
+  {
+    std::vector<std::string> list( paths, paths + count ) ;
+
+    data().assign( list ) ;
+    return data().loadAll() ;
+  }
+
+  NyxFile* NyxLibrary::find( const char* name )
+  {
+    auto iter = std::lower_bound( data().entries.begin(), data().entries.end(), name, []( const NyxLibraryData::Entry& entry, const char* name )
+    {
+      return strcmp( entry.name.c_str(), name ) < 0 ;
+    } ) ;
+
+    // Names can repeat across directories, so skip past any that failed to load.
+    for( ; iter != data().entries.end() && iter->name == name; ++iter )
+    {
+      if( iter->file.error() == NyxError::NoError ) return &iter->file ;
+    }
+
+    return nullptr ;
+  }
+
+  NyxFile* NyxLibrary::file( unsigned index )
+  {
+    return index < data().entries.size() ? &data().entries[ index ].file : nullptr ;
+  }
+
+  const char* NyxLibrary::name( unsigned index ) const
+  {
+    return index < data().entries.size() ? data().entries[ index ].name.c_str() : "" ;
+  }
+
+  const char* NyxLibrary::path( unsigned index ) const
+  {
+    return index < data().entries.size() ? data().entries[ index ].path.c_str() : "" ;
+  }
+
+  NyxError NyxLibrary::error( unsigned index ) const
+  {
+    return index < data().entries.size() ? data().entries[ index ].file.error() : NyxError::NoError ;
+  }
+
+  unsigned NyxLibrary::size() const
+  {
+    return data().entries.size() ;
+  }
+
+  NyxLibraryData& NyxLibrary::data()
+  {
+    return *this->library_data ;
+  }
+
+  const NyxLibraryData& NyxLibrary::data() const
+  {
+    return *this->library_data ;
+  }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "NyxFile.h"
+
+namespace nyx
+{
+  /** Class to load many .nyx files at once, spread over a pool of worker threads.
+   * Files are named by their file name without its extension, and kept ordered by name.
+   */
+  class NyxLibrary
+  {
+    public:
+
+      /** Default constructor.
+       */
+      NyxLibrary() ;
+
+      /** Default deconstructor.
+       */
+      ~NyxLibrary() ;
+
+      /** Method to set the amount of threads files are loaded with.
+       * @param count The amount of threads to load with, or 0 to use one for each hardware thread. Defaults to 0.
+       */
+      void setThreadCount( unsigned count ) ;
+
+      /** Method to set whether reflection data of the loaded files is only decoded once it is first asked for.
+       * @param flag Whether or not to defer decoding the uniforms, inputs & outputs of loaded files.
+       */
+      void setLazyReflection( bool flag ) ;
+
+      /** Method to set whether the checksums of the loaded files are checked before anything in them is decoded.
+       * @param flag Whether or not to reject loaded files that don't match their checksums.
+       */
+      void setVerifyChecksums( bool flag ) ;
+
+      /** Method to load every .nyx file in a directory, replacing whatever this object held before.
+       * @param directory The C-string path of the directory on the filesystem to load the files of.
+       * @return Whether or not the directory could be read and every file in it loaded.
+       */
+      bool load( const char* directory ) ;
+
+      /** Method to load a list of .nyx files, replacing whatever this object held before.
+       * @param paths The C-string paths of the files on the filesystem to load.
+       * @param count The amount of paths in the list.
+       * @return Whether or not every file was loaded.
+       */
+      bool load( const char* const* paths, unsigned count ) ;
+
+      /** Method to find a loaded file by its name.
+       * @param name The C-string name of the file, without its extension.
+       * @return Pointer to the file, or nullptr if this object has no file by that name that loaded.
+       */
+      NyxFile* find( const char* name ) ;
+
+      /** Method to retrieve the file at the specified index.
+       * @param index The index of the file to retrieve.
+       * @return Pointer to the file, or nullptr if the index is out of range.
+       */
+      NyxFile* file( unsigned index ) ;
+
+      /** Method to retrieve the name of the file at the specified index.
+       * @param index The index of the file to retrieve the name of.
+       * @return The C-string name of the file, or an empty string if the index is out of range.
+       */
+      const char* name( unsigned index ) const ;
+
+      /** Method to retrieve the path of the file at the specified index.
+       * @param index The index of the file to retrieve the path of.
+       * @return The C-string path of the file, or an empty string if the index is out of range.
+       */
+      const char* path( unsigned index ) const ;
+
+      /** Method to retrieve why the file at the specified index failed to load.
+       * @param index The index of the file to look up.
+       * @return The error the file failed to load with, or NoError if it loaded or the index is out of range.
+       */
+      NyxError error( unsigned index ) const ;
+
+      /** Method to retrieve the number of files in this object, including any that failed to load.
+       * @return The number of files in this object.
+       */
+      unsigned size() const ;
+
+    private:
+
+      /** Libraries own the files they load, and so cannot be copied.
+       */
+      NyxLibrary( const NyxLibrary& orig ) ;
+      NyxLibrary& operator=( const NyxLibrary& orig ) ;
+
+      /** Forward declared structure containing this object's data.
+       */
+      struct NyxLibraryData* library_data ;
+
+      /** Method to retrieve a reference to this object's internal data structure.
+       * @return Reference to this object's internal data structure.
+       */
+      NyxLibraryData& data() ;
+
+      /** Method to retrieve a const-reference to this object's internal data structure.
+       * @return Const-reference to this object's internal data structure.
+       */
+      const NyxLibraryData& data() const ;
+  };
+}
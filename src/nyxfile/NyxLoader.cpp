@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NyxLoader.h"
+#include "NyxFile.h"
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+namespace nyx
+{
+  /** Structure containing the data of a loader.
+   */
+  struct NyxLoaderData
+  {
+    /** Structure to encompass a single queued load.
+     */
+    struct Job
+    {
+      std::string           path     ; ///< The path of the file on the filesystem.
+      NyxFile*              file     ; ///< The file to load into.
+      std::promise<bool>    promise  ; ///< The promise to fulfill once done, if there is no callback.
+      NyxLoader::Callback   callback ; ///< The function to call once done, if any.
+      bool                  lazy     ; ///< Whether to defer decoding reflection, as set when the load was queued.
+      bool                  verify   ; ///< Whether to check the file's checksums, as set when the load was queued.
+    };
+
+    std::deque<Job>         jobs            ; ///< The loads that have yet to be started.
+    std::mutex              lock            ; ///< The lock guarding everything but the thread.
+    std::condition_variable queued          ; ///< Signalled when a load is queued, or the thread has to stop.
+    std::condition_variable idle            ; ///< Signalled when the thread runs out of loads.
+    std::thread             thread          ; ///< The I/O thread.
+    unsigned                busy    = 0     ; ///< The amount of loads queued or in progress.
+    bool                    lazy    = false ; ///< Whether reflection decoding is deferred until it is first used.
+    bool                    verify  = false ; ///< Whether the checksums of loaded files are checked.
+    bool                    stop    = false ; ///< Whether the thread has to stop once it runs out of loads.
+
+    /** Method to queue a load, with the flags as they are set right now.
+     * @param job The load to queue.
+     */
+    void push( Job&& job ) ;
+
+    /** Method run by the I/O thread, loading files until it has to stop.
+     */
+    void run() ;
+  };
+
+  void NyxLoaderData::push( Job&& job )
+  {
+    {
+      std::lock_guard<std::mutex> guard( this->lock ) ;
+
+      job.lazy   = this->lazy   ;
+      job.verify = this->verify ;
+      this->jobs.push_back( std::move( job ) ) ;
+      this->busy++ ;
+    }
+
+    this->queued.notify_one() ;
+  }
+
+  void NyxLoaderData::run()
+  {
+    std::unique_lock<std::mutex> guard( this->lock ) ;
+
+    while( true )
+    {
+      this->queued.wait( guard, [ this ]() { return this->stop || !this->jobs.empty() ; } ) ;
+      if( this->jobs.empty() ) return ;
+
+      Job job = std::move( this->jobs.front() ) ;
+
+      this->jobs.pop_front() ;
+      guard.unlock() ;
+
+      {
+        NyxFile    loaded                     ;
+        bool       success                    ;
+
+        // The file is only handed over once it is completely parsed, so it never shows up half loaded.
+        loaded.setLazyReflection ( job.lazy   ) ;
+        loaded.setVerifyChecksums( job.verify ) ;
+        success    = loaded.load( job.path.c_str() ) ;
+        *job.file  = std::move( loaded )             ;
+
+        if( job.callback ) job.callback( success ) ;
+        else               job.promise.set_value( success ) ;
+      }
+
+      guard.lock() ;
+      if( --this->busy == 0 ) this->idle.notify_all() ;
+    }
+  }
+
+  NyxLoader::NyxLoader()
+  {
+    this->loader_data = new NyxLoaderData() ;
+    data().thread     = std::thread( &NyxLoaderData::run, this->loader_data ) ;
+  }
+
+  NyxLoader::~NyxLoader()
+  {
+    {
+      std::lock_guard<std::mutex> guard( data().lock ) ;
+      data().stop = true ;
+    }
+
+    data().queued.notify_one() ;
+    data().thread.join() ;
+    delete this->loader_data ;
+  }
+
+  void NyxLoader::setLazyReflection( bool flag )
+  {
+    std::lock_guard<std::mutex> guard( data().lock ) ;
+
+    data().lazy = flag ;
+  }
+
+  void NyxLoader::setVerifyChecksums( bool flag )
+  {
+    std::lock_guard<std::mutex> guard( data().lock ) ;
+
+    data().verify = flag ;
+  }
+
+  std::future<bool> NyxLoader::load( const char* path, NyxFile& file )
+  {
+    NyxLoaderData::Job job    ;
+    std::future<bool>  future ;
+
+    job.path = path  ;
+    job.file = &file ;
+    future   = job.promise.get_future() ;
+
+    data().push( std::move( job ) ) ;
+    return future ;
+  }
+
+  void NyxLoader::load( const char* path, NyxFile& file, Callback callback )
+  {
+    NyxLoaderData::Job job ;
+
+    job.path     = path                  ;
+    job.file     = &file                 ;
+    job.callback = std::move( callback ) ;
+
+    data().push( std::move( job ) ) ;
+  }
+
+  void NyxLoader::wait()
+  {
+    std::unique_lock<std::mutex> guard( data().lock ) ;
+
+    data().idle.wait( guard, [ this ]() { return data().busy == 0 ; } ) ;
+  }
+
+  NyxLoaderData& NyxLoader::data()
+  {
+    return *this->loader_data ;
+  }
+
+  const NyxLoaderData& NyxLoader::data() const
+  {
+    return *this->loader_data ;
+  }
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <future>
+#include <functional>
+
+namespace nyx
+{
+  class NyxFile ;
+
+  /** Class to load .nyx files on a background I/O thread.
+   * Files are mapped & parsed exactly like NyxFile::load does, into a file of the loader's own, which is then
+   * moved into the requested file in one step right before the load is reported as done. Until then the requested
+   * file must be left alone, and it must outlive the load.
+   */
+  class NyxLoader
+  {
+    public:
+
+      /** The function called on the I/O thread once a file is done loading, with whether or not it loaded.
+       */
+      typedef std::function<void( bool )> Callback ;
+
+      /** Default constructor. Starts the I/O thread.
+       */
+      NyxLoader() ;
+
+      /** Default deconstructor. Finishes every load still queued, then stops the I/O thread.
+       */
+      ~NyxLoader() ;
+
+      /** Method to set whether reflection data of the loaded files is only decoded once it is first asked for.
+       * This applies to loads queued after it is set.
+       * @param flag Whether or not to defer decoding the uniforms, inputs & outputs of loaded files.
+       */
+      void setLazyReflection( bool flag ) ;
+
+      /** Method to set whether the checksums of the loaded files are checked before anything in them is decoded.
+       * This applies to loads queued after it is set.
+       * @param flag Whether or not to reject loaded files that don't match their checksums.
+       */
+      void setVerifyChecksums( bool flag ) ;
+
+      /** Method to queue loading the .nyx file at the input path.
+       * @param path The C-string path of the file on the filesystem to load.
+       * @param file The object to load the file into.
+       * @return The future that becomes ready with whether or not the file loaded, once the file can be used.
+       */
+      std::future<bool> load( const char* path, NyxFile& file ) ;
+
+      /** Method to queue loading the .nyx file at the input path.
+       * @param path The C-string path of the file on the filesystem to load.
+       * @param file The object to load the file into.
+       * @param callback The function to call on the I/O thread once the file can be used.
+       */
+      void load( const char* path, NyxFile& file, Callback callback ) ;
+
+      /** Method to wait until every queued load is done.
+       */
+      void wait() ;
+
+    private:
+
+      /** Loaders own a thread, and so cannot be copied.
+       */
+      NyxLoader( const NyxLoader& orig ) ;
+      NyxLoader& operator=( const NyxLoader& orig ) ;
+
+      /** Forward declared structure containing this object's data.
+       */
+      struct NyxLoaderData* loader_data ;
+
+      /** Method to retrieve a reference to this object's internal data structure.
+       * @return Reference to this object's internal data structure.
+       */
+      NyxLoaderData& data() ;
+
+      /** Method to retrieve a const-reference to this object's internal data structure.
+       * @return Const-reference to this object's internal data structure.
+       */
+      const NyxLoaderData& data() const ;
+  };
+}
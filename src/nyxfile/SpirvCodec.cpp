@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SpirvCodec.h"
+#include <string.h>
+
+namespace nyx
+{
+  /** The amount of words in a SPIRV module's header.
+   */
+  constexpr unsigned SPIRV_HEADER_SIZE = 5 ;
+
+  /** Word counts below this are stored along with the opcode, anything else right after it.
+   */
+  constexpr unsigned INLINE_LENGTH = 15 ;
+
+  /** The traits of a SPIRV instruction the encoding makes use of.
+   */
+  enum OpTraits : unsigned
+  {
+    OpPlain  = 0x0, ///< Every operand is stored as a plain varint.
+    OpType   = 0x1, ///< The first operand is a result type.
+    OpResult = 0x2, ///< The next operand is a result id.
+    OpRaw    = 0x4, ///< The remaining operands hold strings, and are stored as they are.
+  };
+
+  /** Method to retrieve the traits of a SPIRV opcode.
+   * @param opcode The opcode to look up.
+   * @return The OpTraits of the opcode.
+   */
+  static inline unsigned traits( unsigned opcode ) ;
+
+  /** Method to write a varint.
+   * @param out The position to write at, advanced past the written bytes.
+   * @param val The value to write.
+   */
+  static inline void putVarint( unsigned char*& out, unsigned val ) ;
+
+  /** Method to read a varint.
+   * @param ptr The position to read at, advanced past the read bytes.
+   * @param end One past the last readable byte.
+   * @param val Set to the value that was read.
+   * @return Whether or not a complete varint was read.
+   */
+  static inline bool getVarint( const unsigned char*& ptr, const unsigned char* end, unsigned& val ) ;
+
+  /** Method to map a signed difference onto small unsigned values.
+   * @param val The difference to map, as wrapped around unsigned arithmetic.
+   * @return The zigzagged difference.
+   */
+  static inline unsigned zigzag( unsigned val ) ;
+
+  /** Method to undo zigzag().
+   * @param val The zigzagged difference.
+   * @return The difference, as wrapped around unsigned arithmetic.
+   */
+  static inline unsigned unzigzag( unsigned val ) ;
+
+  unsigned traits( unsigned opcode )
+  {
+    // OpString & OpExtInstImport, then OpSourceContinued through OpMemberName, OpExtension, OpEntryPoint & OpModuleProcessed.
+    if( opcode == 7 || opcode == 11                                                      ) return OpResult | OpRaw ;
+    if( ( opcode >= 2 && opcode <= 6 ) || opcode == 10 || opcode == 15 || opcode == 330 ) return OpRaw            ;
+
+    // Type declarations, OpDecorationGroup & OpLabel.
+    if( ( opcode >= 19 && opcode <= 38 ) || opcode == 73 || opcode == 248 ) return OpResult ;
+
+    // Stores, copies, image writes & atomic stores have no result.
+    if( ( opcode >= 62 && opcode <= 64 ) || opcode == 99 || opcode == 228 ) return OpPlain ;
+
+    // Constants, functions, memory access, composites, images, conversions, arithmetic, logic, derivatives, atomics & OpPhi.
+    if( opcode == 12 || ( opcode >= 41  && opcode <= 52  ) || ( opcode >= 54  && opcode <= 57  ) || ( opcode >= 59  && opcode <= 70  ) ) return OpType | OpResult ;
+    if( ( opcode >= 77 && opcode <= 107 ) || ( opcode >= 109 && opcode <= 215 ) || ( opcode >= 227 && opcode <= 242 ) || opcode == 245 ) return OpType | OpResult ;
+
+    return OpPlain ;
+  }
+
+  void putVarint( unsigned char*& out, unsigned val )
+  {
+    while( val >= 0x80 )
+    {
+      *out++ = static_cast<unsigned char>( val | 0x80 ) ;
+      val >>= 7 ;
+    }
+
+    *out++ = static_cast<unsigned char>( val ) ;
+  }
+
+  bool getVarint( const unsigned char*& ptr, const unsigned char* end, unsigned& val )
+  {
+    unsigned shift = 0 ;
+
+    val = 0 ;
+    while( ptr < end && shift < 35 )
+    {
+      const unsigned char byte = *ptr++ ;
+
+      val   |= static_cast<unsigned>( byte & 0x7F ) << shift ;
+      shift += 7                                              ;
+      if( !( byte & 0x80 ) ) return true ;
+    }
+
+    return false ;
+  }
+
+  unsigned zigzag( unsigned val )
+  {
+    return ( val << 1 ) ^ ( 0u - ( val >> 31 ) ) ;
+  }
+
+  unsigned unzigzag( unsigned val )
+  {
+    return ( val >> 1 ) ^ ( 0u - ( val & 1 ) ) ;
+  }
+
+  unsigned long long spirvEncodeBound( unsigned count )
+  {
+    // A varint of a word takes at most 5 bytes, and the first word of an instruction at most 6.
+    return static_cast<unsigned long long>( count ) * 6 + SPIRV_HEADER_SIZE * 5 ;
+  }
+
+  unsigned long long encodeSpirv( const unsigned* words, unsigned count, unsigned char* out )
+  {
+    unsigned char* start = out ;
+    unsigned       last  = 0   ;
+    unsigned       index       ;
+
+    if( count < SPIRV_HEADER_SIZE ) return 0 ;
+
+    for( index = 0; index < SPIRV_HEADER_SIZE; index++ ) putVarint( out, words[ index ] ) ;
+
+    while( index < count )
+    {
+      const unsigned length = words[ index ] >> 16    ;
+      const unsigned opcode = words[ index ] & 0xFFFF ;
+      const unsigned flags  = traits( opcode )        ;
+      unsigned       word   = 1                       ;
+
+      if( length == 0 || length > count - index ) return 0 ;
+
+      putVarint( out, opcode << 4 | ( length < INLINE_LENGTH ? length : INLINE_LENGTH ) ) ;
+      if( length >= INLINE_LENGTH ) putVarint( out, length ) ;
+
+      if( ( flags & OpType ) && word < length ) putVarint( out, words[ index + word++ ] ) ;
+      if( ( flags & OpResult ) && word < length )
+      {
+        putVarint( out, zigzag( words[ index + word ] - ( last + 1 ) ) ) ;
+        last = words[ index + word++ ] ;
+      }
+
+      for( ; word < length; word++ )
+      {
+        const unsigned operand = words[ index + word ] ;
+
+             if( flags & OpRaw  ) { memcpy( out, &operand, sizeof( unsigned ) ) ; out += sizeof( unsigned ) ; }
+        else if( flags & OpType ) { putVarint( out, zigzag( last - operand ) ) ;                              }
+        else                      { putVarint( out, operand ) ;                                               }
+      }
+
+      index += length ;
+    }
+
+    return static_cast<unsigned long long>( out - start ) ;
+  }
+
+  bool decodeSpirv( const unsigned char* bytes, unsigned long long size, unsigned* words, unsigned count )
+  {
+    const unsigned char* ptr  = bytes        ;
+    const unsigned char* end  = bytes + size ;
+    unsigned             last = 0            ;
+    unsigned             index               ;
+    unsigned             val                 ;
+
+    if( count < SPIRV_HEADER_SIZE ) return false ;
+
+    for( index = 0; index < SPIRV_HEADER_SIZE; index++ )
+    {
+      if( !getVarint( ptr, end, words[ index ] ) ) return false ;
+    }
+
+    while( index < count )
+    {
+      unsigned length ;
+      unsigned opcode ;
+      unsigned flags  ;
+      unsigned word   ;
+
+      if( !getVarint( ptr, end, val ) ) return false ;
+
+      opcode = val >> 4         ;
+      length = val & 0xF        ;
+      flags  = traits( opcode ) ;
+      word   = 1                ;
+
+      if( length == INLINE_LENGTH && !getVarint( ptr, end, length ) ) return false ;
+      if( length == 0 || length > count - index || opcode > 0xFFFF  ) return false ;
+
+      words[ index ] = length << 16 | opcode ;
+
+      if( ( flags & OpType ) && word < length )
+      {
+        if( !getVarint( ptr, end, words[ index + word++ ] ) ) return false ;
+      }
+      if( ( flags & OpResult ) && word < length )
+      {
+        if( !getVarint( ptr, end, val ) ) return false ;
+        last = words[ index + word++ ] = unzigzag( val ) + last + 1 ;
+      }
+
+      for( ; word < length; word++ )
+      {
+        if( flags & OpRaw )
+        {
+          if( static_cast<unsigned long long>( end - ptr ) < sizeof( unsigned ) ) return false ;
+          memcpy( &words[ index + word ], ptr, sizeof( unsigned ) ) ;
+          ptr += sizeof( unsigned ) ;
+        }
+        else
+        {
+          if( !getVarint( ptr, end, val ) ) return false ;
+          words[ index + word ] = ( flags & OpType ) ? last - unzigzag( val ) : val ;
+        }
+      }
+
+      index += length ;
+    }
+
+    return ptr == end ;
+  }
+}
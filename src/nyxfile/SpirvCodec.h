@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/* A compact, lossless encoding of SPIRV, in the spirit of SMOL-V.
+ *
+ * The five header words are stored as varints. Every instruction then stores its opcode and word count
+ * together in one varint, its result type as a varint, and its result id as the zigzagged difference from
+ * one past the previous result id. The remaining operands of instructions with a result are mostly ids of
+ * recent results, and are stored as the zigzagged difference from the instruction's own result id. The
+ * operands of instructions holding strings are stored as they are, and all others as plain varints.
+ *
+ * Which instructions have a result type or id only affects how small the encoding gets, never whether
+ * decoding it gives back the exact same words.
+ */
+namespace nyx
+{
+  /** Method to retrieve the most bytes that encoding SPIRV can take.
+   * @param count The amount of SPIRV words to encode.
+   * @return The size in bytes a buffer must have to encode that many words into.
+   */
+  unsigned long long spirvEncodeBound( unsigned count ) ;
+
+  /** Method to encode SPIRV.
+   * @param words The SPIRV words to encode.
+   * @param count The amount of SPIRV words.
+   * @param out The buffer to encode into, at least spirvEncodeBound( count ) bytes large.
+   * @return The amount of bytes written, or 0 if the words aren't a well formed SPIRV module.
+   */
+  unsigned long long encodeSpirv( const unsigned* words, unsigned count, unsigned char* out ) ;
+
+  /** Method to decode SPIRV that was encoded with encodeSpirv().
+   * @param bytes The encoded bytes.
+   * @param size The amount of encoded bytes.
+   * @param words The buffer to decode into, which must hold the amount of words that were encoded.
+   * @param count The amount of words that were encoded.
+   * @return Whether or not the bytes decoded into exactly that many words.
+   */
+  bool decodeSpirv( const unsigned char* bytes, unsigned long long size, unsigned* words, unsigned count ) ;
+}
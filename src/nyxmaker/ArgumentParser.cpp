@@ -41,12 +41,16 @@ namespace nyx
   struct ArgParserData
   {
     std::string              include_directory   ;
+    std::string              cache_directory     ;
     std::string              recursive_directory ;
     std::string              output_path         ;
     bool                     output_header       ;
     bool                     verbose             ;
     bool                     build_debug         ;
+    bool                     dependency_file     ;
     bool                     optimize_size       ;
+    bool                     archive             ;
+    bool                     compress            ;
     std::vector<std::string> shaders_paths       ;
 
     ArgParserData() ;
@@ -79,7 +83,10 @@ namespace nyx
     this->output_header       = false     ;
     this->verbose             = false     ;
     this->build_debug         = true      ;
+    this->dependency_file     = false     ;
     this->optimize_size       = false     ;
+    this->archive             = false     ;
+    this->compress            = false     ;
   }
   
   void ArgParserData::printVersion()
@@ -110,10 +117,14 @@ namespace nyx
       if     ( buffer == "-i" && index + 1 < static_cast<unsigned>( num_inputs ) ) { data().include_directory   = std::string( argv[ index + 1 ] ) ; index++ ; }
       else if( buffer == "-o" && index + 1 < static_cast<unsigned>( num_inputs ) ) { data().output_path         = std::string( argv[ index + 1 ] ) ; index++ ; }
       else if( buffer == "-r" && index + 1 < static_cast<unsigned>( num_inputs ) ) { data().recursive_directory = std::string( argv[ index + 1 ] ) ; index++ ; }
+      else if( buffer == "-c" && index + 1 < static_cast<unsigned>( num_inputs ) ) { data().cache_directory     = std::string( argv[ index + 1 ] ) ; index++ ; }
       else if( buffer == "-h"                                                    ) { data().output_header       = true                             ;           }
       else if( buffer == "-release"                                              ) { data().build_debug         = false                            ;           }
       else if( buffer == "-size_opt"                                             ) { data().optimize_size       = true                             ;           }
       else if( buffer == "-v"                                                    ) { data().verbose             = true                             ;           }
+      else if( buffer == "-a"                                                    ) { data().archive             = true                             ;           }
+      else if( buffer == "-compress"                                             ) { data().compress            = true                             ;           }
+      else if( buffer == "-MD"                                                   ) { data().dependency_file     = true                             ;           }
       else if( buffer == "--version"                                             ) { data().printVersion() ;                                                   }
       else                                                                         { data().shaders_paths.push_back( std::string( argv[ index ] ) );           }
     }
@@ -134,6 +145,21 @@ namespace nyx
     return data().optimize_size ;
   }
 
+  bool ArgumentParser::archive() const
+  {
+    return data().archive ;
+  }
+
+  bool ArgumentParser::compressSpirv() const
+  {
+    return data().compress ;
+  }
+
+  bool ArgumentParser::dependencyFile() const
+  {
+    return data().dependency_file ;
+  }
+
   bool ArgumentParser::recursive() const
   {
     return data().recursive_directory != "" ;
@@ -149,7 +175,7 @@ namespace nyx
     static std::string extention ;
     static std::string path ;
 
-    extention = ".nyx" ;
+    extention = data().archive ? ".nyxa" : ".nyx" ;
     path = data().output_path + extention ;
     return path.c_str() ;
   }
@@ -179,6 +205,11 @@ namespace nyx
     return data().include_directory.c_str() ;
   }
   
+  const char* ArgumentParser::getCacheDirectory() const
+  {
+    return data().cache_directory.c_str() ;
+  }
+  
   const char* ArgumentParser::getFilePath( unsigned index ) const
   {
     return index < data().shaders_paths.size() ? data().shaders_paths[ index ].c_str() : "" ;
@@ -192,10 +223,18 @@ namespace nyx
     "              -> Recursively parses all files in the directory.\n" 
     "           -i <directory>\n"                                 
     "              -> Sets the directory on the filesystem to use as the include directory for GLSL shader compilation.\n" 
+    "           -c <directory>\n"
+    "              -> Caches compiled shaders in the directory, & reuses them for shaders that have not changed since.\n"
     "           -v\n"                                                   
     "              -> Verbose output.\n"
     "           -h\n"                                                   
     "              -> Outputs a C-header containing the binary data of this file.\n"
+    "           -MD\n"
+    "              -> Writes the files the output depends on to a Make/Ninja depfile next to it, & skips compiling when none of them nor the options changed since.\n"
+    "           -compress\n"
+    "              -> Compresses the SPIRV of every shader stage, to be decoded when the file is loaded.\n"
+    "           -a\n"
+    "              -> Packs the input .nyx files into a single .nyxa archive instead of compiling shaders, each named by its file name.\n"
     "           -o <name>\n"                                                   
     "              -> The output name, if not using recursive. File extension is automatically appended to input\n" ) ;
     return program_usage.c_str() ;
@@ -48,6 +48,11 @@ namespace nyx
        */
       bool recursive() const ;
       
+      /** Method to retrieve whether or not this program should pack its inputs into an archive instead of compiling them.
+       * @return Whether or not the inputs are .nyx files to archive.
+       */
+      bool archive() const ;
+
       /** Method to retrieve whether or not this program should output a header file containing the shader data.
        * @return Whether or not this program should output a header file containing this file data.
        */
@@ -65,11 +70,27 @@ namespace nyx
       
       bool buildDebug() const ;
       bool optimizeSize() const ;
+
+      /** Method to retrieve whether or not the SPIRV of the output should be compressed.
+       * @return Whether or not to compress the SPIRV of every shader stage.
+       */
+      bool compressSpirv() const ;
+
+      /** Method to retrieve whether or not a depfile should be written next to the output.
+       * @return Whether or not to write the output's dependencies, & skip compiling when the output is up to date.
+       */
+      bool dependencyFile() const ;
+
       /** Method to get the include directory, if any, set by the passed in arguments.
        * @return The string representation of the include directory on the file systems.
        */
       const char* getIncludeDirectory() const ;
 
+      /** Method to get the cache directory, if any, set by the passed in arguments.
+       * @return The string representation of the cache directory on the file system, or an empty string if there is none.
+       */
+      const char* getCacheDirectory() const ;
+
       /** Method to retrieve the file path for the specified index of input.
        * @param index The index of input to receive the file path of.
        * @return const char* The string representation to the shader on the filesystem.
@@ -102,13 +102,13 @@ namespace nyx
     unsigned line_count = 0 ;
     if( this->output )
     {
-      this->output << ( "#pragma once\n"              ) ;
-      this->output << ( "\n"                          ) ;
-      this->output << ( "namespace nyx\n"             ) ;
-      this->output << ( "{\n"                         ) ;
-      this->output << ( "  namespace bytes\n"         ) ;
-      this->output << ( "  {\n"                       ) ;
-      this->output << ( "    const unsigned char "    ) ;
+      this->output << ( "#pragma once\n"                         ) ;
+      this->output << ( "\n"                                     ) ;
+      this->output << ( "namespace nyx\n"                        ) ;
+      this->output << ( "{\n"                                    ) ;
+      this->output << ( "  namespace bytes\n"                    ) ;
+      this->output << ( "  {\n"                                  ) ;
+      this->output << ( "    alignas( 16 ) const unsigned char " ) ;
       this->output << file_name                         ;
       this->output << "[] = \n    {\n      "            ;
       
@@ -149,6 +149,13 @@ namespace nyx
     data().write( getFilepath( file_path ), getFilename( file_path ) ) ;
   }
 
+  std::string HeaderMaker::header( const char* file_path ) const
+  {
+    const std::string directory = getFilepath( file_path ) ;
+
+    return directory.empty() ? getFilename( file_path ) : directory + std::string( "/" ) + getFilename( file_path ) ;
+  }
+
   HeaderMakerData& HeaderMaker::data()
   {
     return *this->maker_data ;
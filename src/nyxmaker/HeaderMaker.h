@@ -12,6 +12,7 @@
  */
 
 #pragma once
+#include <string>
 namespace nyx
 {
   class HeaderMaker
@@ -20,6 +21,7 @@ namespace nyx
       HeaderMaker() ;
       ~HeaderMaker() ;
       void make( const char* file_path ) ;
+      std::string header( const char* file_path ) const ;
     private:
       HeaderMaker( const HeaderMaker& orig ) ;
       HeaderMaker& operator=( const HeaderMaker& orig ) ;
@@ -17,13 +17,16 @@
 
 
 #include "../nyxwriter/NyxWriter.h"
+#include "../nyxwriter/NyxArchiveWriter.h"
 #include "../nyxfile/NyxFile.h"
+#include "../nyxfile/NyxArchive.h"
 #include "ArgumentParser.h"
 #include "HeaderMaker.h"
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <vector>
 #if defined ( __unix__ ) || defined( _WIN32 )
   constexpr const char* COLOR_END    = "\x1B[m"       ;
   constexpr const char* COLOR_RED    = "\u001b[31m"   ;
@@ -49,6 +52,12 @@
 static std::string loadStream( std::ifstream& stream ) ;
 static ::nyx::ShaderStage extensionToStage( std::string extension ) ;
 static std::string getExtension( const std::string& name ) ;
+static void makeArchive( const ::nyx::ArgumentParser& parser ) ;
+static std::string escapeDependency( const std::string& path ) ;
+static std::vector<std::string> readDependencies( const std::string& path ) ;
+static void writeDependencies( const ::nyx::ArgumentParser& parser, const ::nyx::NyxWriter& writer ) ;
+static std::string buildOptions( const ::nyx::ArgumentParser& parser ) ;
+static bool upToDate( const ::nyx::ArgumentParser& parser ) ;
 
 std::string loadStream( std::ifstream& stream )
 {
@@ -75,6 +84,181 @@ std::string getExtension( const std::string& name )
   return ::nyx::ShaderStage::Vertex ;
 }
 
+void makeArchive( const ::nyx::ArgumentParser& parser )
+{
+  ::nyx::NyxArchiveWriter writer  ;
+  ::nyx::NyxArchive       archive ;
+  ::nyx::NyxFile          file    ;
+
+  for( unsigned i = 0; i < parser.getNumberOfInputs(); i++ )
+  {
+    if( parser.verbose() )
+    {
+      std::cout << ::COLOR_BOLD <<  "Archiving: " << parser.getFilePath( i ) << ::COLOR_END << std::endl ;
+    }
+
+    writer.add( std::filesystem::path( parser.getFilePath( i ) ).stem().string().c_str(), parser.getFilePath( i ) ) ;
+  }
+
+  writer.save( parser.output() ) ;
+  if( parser.outputHeader() )
+  {
+    nyx::HeaderMaker maker ;
+    maker.make( parser.output() ) ;
+  }
+
+  if( parser.verbose() )
+  {
+    if( !archive.load( parser.output() ) )
+    {
+      std::cout << ::COLOR_RED << "Cannot load archive " << parser.output() << ::COLOR_END << std::endl ;
+      exit( -1 ) ;
+    }
+
+    std::cout << COLOR_BOLD << "Archive: " << parser.output() << "\n" << COLOR_END << std::endl ;
+    for( unsigned i = 0; i < archive.size(); i++ )
+    {
+      archive.find( archive.name( i ), file ) ;
+      std::cout << COLOR_BOLD << "-- Name: " << archive.name( i ) << "\n" ;
+      std::cout << COLOR_BOLD << "--   └─Num Shaders : " << file.size() << COLOR_END << "\n" ;
+      std::cout << "\n" ;
+    }
+  }
+}
+
+std::string escapeDependency( const std::string& path )
+{
+  std::string escaped ;
+
+  for( char ch : path )
+  {
+         if( ch == ' ' || ch == '#' ) escaped += '\\' ;
+    else if( ch == '$'              ) escaped += '$'  ;
+
+    escaped += ch ;
+  }
+
+  return escaped ;
+}
+
+std::vector<std::string> readDependencies( const std::string& path )
+{
+  std::vector<std::string> dependencies ;
+  std::ifstream            stream       ;
+  std::string              contents     ;
+  std::string              dependency   ;
+  size_t                   start        ;
+
+  stream.open( path ) ;
+  if( !stream ) return dependencies ;
+
+  // Everything after the target is a list of paths separated by whitespace, undoing the escapes of escapeDependency.
+  contents = loadStream( stream ) ;
+  start    = contents.find( ": " ) ;
+  if( start == std::string::npos ) return dependencies ;
+
+  for( size_t index = start + 2; index <= contents.size(); index++ )
+  {
+    const char ch = index < contents.size() ? contents[ index ] : '\n' ;
+
+    if( ch == '\\' && index + 1 < contents.size() && ( contents[ index + 1 ] == ' ' || contents[ index + 1 ] == '#' ) )
+    {
+      dependency += contents[ ++index ] ;
+    }
+    else if( ch == '$' && index + 1 < contents.size() && contents[ index + 1 ] == '$' )
+    {
+      dependency += contents[ ++index ] ;
+    }
+    else if( ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t' || ch == '\\' )
+    {
+      if( !dependency.empty() ) dependencies.push_back( dependency ) ;
+      dependency.clear() ;
+    }
+    else
+    {
+      dependency += ch ;
+    }
+  }
+
+  return dependencies ;
+}
+
+void writeDependencies( const ::nyx::ArgumentParser& parser, const ::nyx::NyxWriter& writer )
+{
+  std::ofstream stream ;
+
+  stream.open( std::string( parser.output() ) + ".d" ) ;
+  if( !stream )
+  {
+    std::cout << ::COLOR_RED << "Cannot write dependency file for " << parser.output() << ::COLOR_END << std::endl ;
+    exit( -1 ) ;
+  }
+
+  stream << escapeDependency( parser.output() ) << ":" ;
+  for( unsigned i = 0; i < parser.getNumberOfInputs(); i++ ) stream << " \\\n  " << escapeDependency( parser.getFilePath( i ) ) ;
+  for( unsigned i = 0; i < writer.numDependencies()  ; i++ ) stream << " \\\n  " << escapeDependency( writer.dependency( i ) ) ;
+  stream << "\n" ;
+  stream.close() ;
+
+  // The options are kept next to the dependency file, as build tools would not understand them inside of it.
+  stream.open( std::string( parser.output() ) + ".options" ) ;
+  if( !stream )
+  {
+    std::cout << ::COLOR_RED << "Cannot write dependency file for " << parser.output() << ::COLOR_END << std::endl ;
+    exit( -1 ) ;
+  }
+
+  stream << buildOptions( parser ) ;
+}
+
+std::string buildOptions( const ::nyx::ArgumentParser& parser )
+{
+  std::string options ;
+
+  options += "debug "    + std::to_string( parser.buildDebug()    ) + "\n" ;
+  options += "size_opt " + std::to_string( parser.optimizeSize()  ) + "\n" ;
+  options += "compress " + std::to_string( parser.compressSpirv() ) + "\n" ;
+  options += "include "  + std::string( parser.getIncludeDirectory() ) + "\n" ;
+  for( unsigned i = 0; i < parser.getNumberOfInputs(); i++ )
+  {
+    options += "input " + std::to_string( parser.getShaderType( i ) ) + " " + parser.getFilePath( i ) + "\n" ;
+  }
+
+  return options ;
+}
+
+bool upToDate( const ::nyx::ArgumentParser& parser )
+{
+  const std::vector<std::string> dependencies = readDependencies( std::string( parser.output() ) + ".d" ) ;
+
+  std::error_code                 error   ;
+  std::filesystem::file_time_type output  ;
+  std::ifstream                   stream  ;
+  ::nyx::HeaderMaker              maker   ;
+
+  output = std::filesystem::last_write_time( parser.output(), error ) ;
+  if( error || dependencies.empty() ) return false ;
+
+  // Any change to the options or the inputs makes it out of date, as the output was built with the old ones.
+  stream.open( std::string( parser.output() ) + ".options" ) ;
+  if( !stream || loadStream( stream ) != buildOptions( parser ) ) return false ;
+
+  // A header older than the output, or one that is missing, has to be made again as well.
+  if( parser.outputHeader() )
+  {
+    const auto time = std::filesystem::last_write_time( maker.header( parser.output() ), error ) ;
+    if( error || time < output ) return false ;
+  }
+
+  for( const auto& dependency : dependencies )
+  {
+    const auto time = std::filesystem::last_write_time( dependency, error ) ;
+    if( error || time > output ) return false ;
+  }
+
+  return true ;
+}
+
 int main( int argc, const char** argv )
 {
   std::ifstream         stream           ;
@@ -89,9 +273,15 @@ int main( int argc, const char** argv )
   parser.parse( argc, argv ) ;
   shader.setBuildDebug      ( parser.buildDebug()          ) ;
   shader.setOptimizeSize    ( parser.optimizeSize()        ) ;
+  shader.setCompressSpirv   ( parser.compressSpirv()       ) ;
   shader.setIncludeDirectory( parser.getIncludeDirectory() ) ;
+  shader.setCacheDirectory  ( parser.getCacheDirectory()   ) ;
   
-  if( parser.valid() )
+  if( parser.valid() && parser.archive() )
+  {
+    makeArchive( parser ) ;
+  }
+  else if( parser.valid() )
   {
     if( parser.recursive() )
     {
@@ -110,6 +300,12 @@ int main( int argc, const char** argv )
       }      
     }
 
+    if( parser.dependencyFile() && !parser.recursive() && upToDate( parser ) )
+    {
+      if( parser.verbose() ) std::cout << ::COLOR_BOLD << "Up to date: " << parser.output() << ::COLOR_END << std::endl ;
+      return 0 ;
+    }
+
     for( unsigned i = 0; i < parser.getNumberOfInputs(); i++ )
     {
       if( parser.verbose() )
@@ -132,6 +328,7 @@ int main( int argc, const char** argv )
     }
     
     shader.save( parser.output() ) ;
+    if( parser.dependencyFile() ) writeDependencies( parser, shader ) ;
     if( parser.outputHeader() )
     {
       nyx::HeaderMaker maker ;
@@ -140,7 +337,7 @@ int main( int argc, const char** argv )
 
     if( parser.verbose() )
     {
-      shader_validator.load( parser.output() ) ;
+      shader.extract( shader_validator ) ;
       std::cout << COLOR_BOLD << "Include Directory: " << parser.getIncludeDirectory() << "\n" << COLOR_END << std::endl ;
       
       if( shader_validator.numInputs() != 0 ) std::cout << COLOR_BOLD << "Pipeline Inputs: \n\n" << COLOR_END ;
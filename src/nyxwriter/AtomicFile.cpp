@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AtomicFile.h"
+#include <string>
+#include <random>
+#include <cstdio>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <errno.h>
+#elif defined( _WIN32 )
+  #define WIN32_LEAN_AND_MEAN
+  #include <windows.h>
+#else
+  #include <fstream>
+#endif
+
+namespace nyx
+{
+  /** Method to write bytes to a new file, flushing them to disk if asked to.
+   * @param path The path on the filesystem of the file to create.
+   * @param bytes The bytes to write to the file.
+   * @param size The amount of bytes to write.
+   * @param flush Whether to wait for the bytes to reach the disk.
+   * @return Whether or not every byte was written.
+   */
+  static bool writeTemporary( const char* path, const unsigned char* bytes, unsigned long long size, bool flush ) ;
+
+  /** Method to move a file over another, replacing it.
+   * @param from The path on the filesystem of the file to move.
+   * @param to The path on the filesystem to move it to.
+   * @param flush Whether to wait for the move to reach the disk.
+   * @return Whether or not the file was moved.
+   */
+  static bool replace( const char* from, const char* to, bool flush ) ;
+
+  bool writeTemporary( const char* path, const unsigned char* bytes, unsigned long long size, bool flush )
+  {
+  #if defined( __unix__ ) || defined( __APPLE__ )
+    bool ok = true ;
+    int  fd        ;
+
+    fd = ::open( path, O_WRONLY | O_CREAT | O_TRUNC, 0644 ) ;
+    if( fd < 0 ) return false ;
+
+    // A single write may still be cut short, so whatever is left is written until nothing is.
+    while( ok && size != 0 )
+    {
+      const ssize_t written = ::write( fd, bytes, size ) ;
+
+      if( written < 0 && errno == EINTR ) continue ;
+
+      ok     = written > 0 ;
+      bytes += ok ? written : 0 ;
+      size  -= ok ? written : 0 ;
+    }
+
+    if( ok && flush ) ok = ::fsync( fd ) == 0 ;
+    if( ::close( fd ) != 0 ) ok = false ;
+    return ok ;
+  #elif defined( _WIN32 )
+    HANDLE file ;
+    DWORD  written ;
+    bool   ok = true ;
+
+    file = ::CreateFileA( path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr ) ;
+    if( file == INVALID_HANDLE_VALUE ) return false ;
+
+    while( ok && size != 0 )
+    {
+      const DWORD amount = size > 0x40000000ull ? 0x40000000u : static_cast<DWORD>( size ) ;
+
+      ok     = ::WriteFile( file, bytes, amount, &written, nullptr ) && written != 0 ;
+      bytes += ok ? written : 0 ;
+      size  -= ok ? written : 0 ;
+    }
+
+    if( ok && flush ) ok = ::FlushFileBuffers( file ) != 0 ;
+    if( !::CloseHandle( file ) ) ok = false ;
+    return ok ;
+  #else
+    std::ofstream stream ;
+
+    ( void )flush ;
+    stream.open( path, std::ios::binary ) ;
+    stream.write( reinterpret_cast<const char*>( bytes ), size ) ;
+    stream.close() ;
+    return static_cast<bool>( stream ) ;
+  #endif
+  }
+
+  bool replace( const char* from, const char* to, bool flush )
+  {
+  #if defined( __unix__ ) || defined( __APPLE__ )
+    std::string directory = to ;
+    int         fd             ;
+
+    if( ::rename( from, to ) != 0 ) return false ;
+
+    // The rename lives in the directory, which has to be flushed as well for the new file to survive a crash.
+    if( flush )
+    {
+      directory = directory.find( '/' ) == std::string::npos ? std::string( "." ) : directory.substr( 0, directory.rfind( '/' ) + 1 ) ;
+      fd        = ::open( directory.c_str(), O_RDONLY ) ;
+
+      if( fd >= 0 )
+      {
+        ::fsync( fd ) ;
+        ::close( fd ) ;
+      }
+    }
+
+    return true ;
+  #elif defined( _WIN32 )
+    return ::MoveFileExA( from, to, MOVEFILE_REPLACE_EXISTING | ( flush ? MOVEFILE_WRITE_THROUGH : 0 ) ) != 0 ;
+  #else
+    ( void )flush ;
+    return std::rename( from, to ) == 0 ;
+  #endif
+  }
+
+  bool writeAtomically( const char* path, const unsigned char* bytes, unsigned long long size, bool flush )
+  {
+    std::random_device rng       ;
+    std::string        temporary ;
+
+    temporary = std::string( path ) + "." + std::to_string( rng() ) + ".tmp" ;
+
+    if( writeTemporary( temporary.c_str(), bytes, size, flush ) && replace( temporary.c_str(), path, flush ) ) return true ;
+
+    std::remove( temporary.c_str() ) ;
+    return false ;
+  }
+}
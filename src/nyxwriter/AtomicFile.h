@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NYX_ATOMIC_FILE_H
+#define NYX_ATOMIC_FILE_H
+
+namespace nyx
+{
+  /** Method to replace a file with the input bytes, so that it is never seen half written, not even after a crash.
+   * The bytes are written in one go to a temporary file next to it, which is then renamed over the file. When flushed, the
+   * temporary file reaches the disk before the rename, so a power loss leaves either the old file or the new one in place.
+   * @param path The path on the filesystem of the file to replace.
+   * @param bytes The bytes to write to the file.
+   * @param size The amount of bytes to write.
+   * @param flush Whether to wait for the bytes to reach the disk before renaming, which only files that must survive a crash need.
+   * @return Whether or not the file was replaced. If not, it is left as it was.
+   */
+  bool writeAtomically( const char* path, const unsigned char* bytes, unsigned long long size, bool flush = true ) ;
+}
+
+#endif
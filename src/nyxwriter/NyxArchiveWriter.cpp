@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NyxArchiveWriter.h"
+#include "AtomicFile.h"
+#include <nyxfile/NyxFormat.h>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+namespace nyx
+{
+  #if defined ( __unix__ ) || defined( _WIN32 )
+    constexpr const char* COLOR_END = "\x1B[m"     ;
+    constexpr const char* COLOR_RED = "\u001b[31m" ;
+  #else
+    constexpr const char* COLOR_END = "" ;
+    constexpr const char* COLOR_RED = "" ;
+  #endif
+
+  /** Structure containing the data of an archive writer.
+   */
+  struct NyxArchiveWriterData
+  {
+    typedef std::vector<unsigned char>                  Bytes  ;
+    typedef std::map<std::string, Bytes>                Files  ;
+    typedef std::multimap<unsigned long long, unsigned> Hashes ;
+
+    /** Structure to encompass a .nyx file as it is laid out in the archive.
+     */
+    struct Image
+    {
+      Bytes                                      bytes  ; ///< The file's bytes, without any of its shared SPIRV.
+      std::vector<std::pair<unsigned, unsigned>> shared ; ///< The index of every section pointing at shared SPIRV, with the index of that SPIRV.
+    };
+
+    Files              files  ; ///< The .nyx files to archive, sorted by their name.
+    std::vector<Bytes> blobs  ; ///< Every distinct SPIRV of the archived files.
+    Hashes             hashes ; ///< The index of every blob, by the hash of its contents.
+
+    /** Method to round a size up to the section alignment.
+     * @param size The size in bytes to round up.
+     * @return The size in bytes, padded out to the next section boundary.
+     */
+    unsigned aligned( unsigned size ) const ;
+
+    /** Method to hash a range of bytes ( 64 bit FNV-1a ).
+     * @param bytes The first byte of the range.
+     * @param size The amount of bytes in the range.
+     * @return The hash of the bytes.
+     */
+    unsigned long long hash( const unsigned char* bytes, unsigned size ) const ;
+
+    /** Method to store a SPIRV blob only once, no matter how many files contain it.
+     * @param bytes The first byte of the SPIRV.
+     * @param size The amount of bytes of SPIRV.
+     * @return The index of the blob holding the SPIRV.
+     */
+    unsigned intern( const unsigned char* bytes, unsigned size ) ;
+
+    /** Method to lay a .nyx file out for the archive, moving its SPIRV, compressed or not, out into the shared blobs.
+     * Files that aren't version 2 .nyx files are archived as they are.
+     * @param file The bytes of the .nyx file.
+     * @param image The image to lay the file out into.
+     */
+    void split( const Bytes& file, Image& image ) ;
+  };
+
+  unsigned NyxArchiveWriterData::aligned( unsigned size ) const
+  {
+    return ( size + SECTION_ALIGNMENT - 1 ) / SECTION_ALIGNMENT * SECTION_ALIGNMENT ;
+  }
+
+  unsigned long long NyxArchiveWriterData::hash( const unsigned char* bytes, unsigned size ) const
+  {
+    unsigned long long hash = 14695981039346656037ull ;
+
+    for( unsigned index = 0; index < size; index++ )
+    {
+      hash ^= bytes[ index ]   ;
+      hash *= 1099511628211ull ;
+    }
+
+    return hash ;
+  }
+
+  unsigned NyxArchiveWriterData::intern( const unsigned char* bytes, unsigned size )
+  {
+    const unsigned long long key   = this->hash( bytes, size )        ;
+    const auto               range = this->hashes.equal_range( key ) ;
+
+    // Equal hashes are only a hint, the contents have to match too.
+    for( auto iter = range.first; iter != range.second; ++iter )
+    {
+      const Bytes& blob = this->blobs[ iter->second ] ;
+
+      if( blob.size() == size && memcmp( blob.data(), bytes, size ) == 0 ) return iter->second ;
+    }
+
+    this->blobs.emplace_back( bytes, bytes + size ) ;
+    this->hashes.insert( { key, static_cast<unsigned>( this->blobs.size() - 1 ) } ) ;
+    return this->blobs.size() - 1 ;
+  }
+
+  void NyxArchiveWriterData::split( const Bytes& file, Image& image )
+  {
+    std::vector<NyxSection> sections ;
+    NyxHeader               header   ;
+    unsigned long long      table    ;
+
+    image.bytes  = file ;
+    image.shared.clear() ;
+
+    if( file.size() < sizeof( NyxHeader ) ) return ;
+    memcpy( &header, file.data(), sizeof( NyxHeader ) ) ;
+
+    table = sizeof( NyxHeader ) + static_cast<unsigned long long>( header.num_sections ) * sizeof( NyxSection ) ;
+    if( header.magic != MAGIC || header.version != NYXFILE_VERSION || table > file.size() ) return ;
+
+    sections.resize( header.num_sections ) ;
+    memcpy( sections.data(), file.data() + sizeof( NyxHeader ), header.num_sections * sizeof( NyxSection ) ) ;
+
+    for( const auto& section : sections )
+    {
+      if( static_cast<unsigned long long>( section.offset ) + section.size > file.size() ) return ;
+    }
+
+    // Every section but the SPIRV is copied back in behind the table, the SPIRV is pointed at its blob once the archive is laid out.
+    image.bytes.assign( file.begin(), file.begin() + table ) ;
+    for( unsigned index = 0; index < sections.size(); index++ )
+    {
+      const unsigned char* payload = file.data() + sections[ index ].offset ;
+
+      if( sections[ index ].type == SectionType::SpirvSection || sections[ index ].type == SectionType::CompressedSpirvSection )
+      {
+        image.shared.push_back( { index, this->intern( payload, sections[ index ].size ) } ) ;
+        continue ;
+      }
+
+      sections[ index ].offset = image.bytes.size() ;
+      image.bytes.insert( image.bytes.end(), payload, payload + sections[ index ].size ) ;
+      image.bytes.resize( this->aligned( image.bytes.size() ), 0 ) ;
+    }
+
+    header.file_size = image.bytes.size() ;
+    memcpy( image.bytes.data(), &header, sizeof( NyxHeader ) ) ;
+    memcpy( image.bytes.data() + sizeof( NyxHeader ), sections.data(), sections.size() * sizeof( NyxSection ) ) ;
+  }
+
+  NyxArchiveWriter::NyxArchiveWriter()
+  {
+    this->archive_data = new NyxArchiveWriterData() ;
+  }
+
+  NyxArchiveWriter::~NyxArchiveWriter()
+  {
+    delete this->archive_data ;
+  }
+
+  void NyxArchiveWriter::add( const char* name, const char* path )
+  {
+    std::ifstream stream ;
+
+    stream.open( path, std::ios::binary ) ;
+    if( !stream )
+    {
+      std::cout << COLOR_RED << "Unable to open file :" << path << COLOR_END << std::endl ;
+      exit( -1 ) ;
+    }
+
+    data().files[ name ].assign( ( std::istreambuf_iterator<char>( stream ) ), std::istreambuf_iterator<char>() ) ;
+  }
+
+  void NyxArchiveWriter::add( const char* name, const unsigned char* bytes, unsigned size )
+  {
+    data().files[ name ].assign( bytes, bytes + size ) ;
+  }
+
+  void NyxArchiveWriter::save( const char* path )
+  {
+    typedef NyxArchiveWriterData::Bytes Bytes ;
+    typedef NyxArchiveWriterData::Image Image ;
+
+    std::vector<NyxArchiveEntry> entries ;
+    std::vector<Image>           images  ;
+    std::vector<unsigned>        blobs   ;
+    NyxArchiveHeader             header  ;
+    NyxSection                   section ;
+    Bytes                        names   ;
+    Bytes                        bytes   ;
+    unsigned                     offset  ;
+
+    data().blobs .clear() ;
+    data().hashes.clear() ;
+
+    // Files are laid out after the header and the directory, each starting on the section alignment.
+    offset = sizeof( NyxArchiveHeader ) + data().files.size() * sizeof( NyxArchiveEntry ) ;
+    for( const auto& file : data().files )
+    {
+      images.emplace_back() ;
+      data().split( file.second, images.back() ) ;
+
+      entries.push_back( { static_cast<unsigned>( names.size() ), 0, offset, static_cast<unsigned>( images.back().bytes.size() ) } ) ;
+      names.insert( names.end(), file.first.begin(), file.first.end() ) ;
+      names.push_back( '\0' ) ;
+
+      offset += data().aligned( images.back().bytes.size() ) ;
+    }
+
+    // The shared SPIRV follows every file, so sections can point at it with their offsets from the start of their own file.
+    for( const auto& blob : data().blobs )
+    {
+      blobs.push_back( offset ) ;
+      offset += data().aligned( blob.size() ) ;
+    }
+
+    for( unsigned index = 0; index < images.size(); index++ )
+    {
+      for( const auto& shared : images[ index ].shared )
+      {
+        unsigned char* raw = images[ index ].bytes.data() + sizeof( NyxHeader ) + shared.first * sizeof( NyxSection ) ;
+
+        memcpy( &section, raw, sizeof( NyxSection ) ) ;
+        section.offset = blobs[ shared.second ] - entries[ index ].offset ;
+        memcpy( raw, &section, sizeof( NyxSection ) ) ;
+      }
+    }
+
+    // An archive without files still has a terminated, empty name.
+    if( names.empty() ) names.push_back( '\0' ) ;
+
+    header.magic        = ARCHIVE_MAGIC         ;
+    header.version      = ARCHIVE_VERSION       ;
+    header.num_entries  = entries.size()        ;
+    header.names_offset = offset                ;
+    header.names_size   = names.size()          ;
+    header.file_size    = offset + names.size() ;
+    header.reserved     = 0                     ;
+
+    // The whole archive is put together in memory first, leaving the padding zeroed, so it reaches the disk in one write.
+    bytes.assign( header.file_size, 0 ) ;
+    offset = sizeof( NyxArchiveHeader ) ;
+
+    memcpy( bytes.data(), &header, sizeof( NyxArchiveHeader ) ) ;
+    if( !entries.empty() ) memcpy( bytes.data() + offset, entries.data(), sizeof( NyxArchiveEntry ) * entries.size() ) ;
+
+    offset += sizeof( NyxArchiveEntry ) * entries.size() ;
+    for( const auto& image : images )
+    {
+      std::copy( image.bytes.begin(), image.bytes.end(), bytes.begin() + offset ) ;
+      offset += data().aligned( image.bytes.size() ) ;
+    }
+    for( const auto& blob : data().blobs )
+    {
+      std::copy( blob.begin(), blob.end(), bytes.begin() + offset ) ;
+      offset += data().aligned( blob.size() ) ;
+    }
+    std::copy( names.begin(), names.end(), bytes.begin() + offset ) ;
+
+    if( !writeAtomically( path, bytes.data(), bytes.size() ) )
+    {
+      std::cout << COLOR_RED << "Unable to open file :" << path << COLOR_END << std::endl ;
+      exit( -1 ) ;
+    }
+  }
+
+  unsigned NyxArchiveWriter::size() const
+  {
+    return data().files.size() ;
+  }
+
+  NyxArchiveWriterData& NyxArchiveWriter::data()
+  {
+    return *this->archive_data ;
+  }
+
+  const NyxArchiveWriterData& NyxArchiveWriter::data() const
+  {
+    return *this->archive_data ;
+  }
+}
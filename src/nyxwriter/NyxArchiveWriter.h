@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NYX_ARCHIVE_WRITER_H
+#define NYX_ARCHIVE_WRITER_H
+
+namespace nyx
+{
+  /** Class to pack many .nyx files into a single .nyxa archive.
+   */
+  class NyxArchiveWriter
+  {
+    public:
+
+      /** Default Constructor.
+       */
+      NyxArchiveWriter() ;
+
+      /** Default Deconstructor.
+       */
+      ~NyxArchiveWriter() ;
+
+      /** Method to add the .nyx file at the input path to the archive.
+       * @param name The name to archive the file with. Adding a name again replaces the file archived with it.
+       * @param path The C-string path of the .nyx file on the filesystem.
+       */
+      void add( const char* name, const char* path ) ;
+
+      /** Method to add a .nyx file in memory to the archive.
+       * @param name The name to archive the file with. Adding a name again replaces the file archived with it.
+       * @param bytes The array of bytes containing the .nyx file's data.
+       * @param size The amount of bytes in the array.
+       */
+      void add( const char* name, const unsigned char* bytes, unsigned size ) ;
+
+      /** Method to save the archive to disk.
+       * The archive replaces any file at the path only once it is fully on disk, so readers never see it half written.
+       * @param path The path on the filesystem to save the .nyxa data to.
+       */
+      void save( const char* path ) ;
+
+      /** Method to retrieve the size of this object.
+       * @return The number of files added to this object.
+       */
+      unsigned size() const ;
+
+    private:
+
+        /** Forward declared structure containing this object's data.
+         */
+      struct NyxArchiveWriterData* archive_data ;
+
+        /** Method to retrieve a reference to this object's internal data structure.
+         * @return Reference to this object's internal data structure.
+         */
+      NyxArchiveWriterData& data() ;
+
+        /** Method to retrieve a const-reference to this object's internal data structure.
+         * @return Const-reference to this object's internal data structure.
+         */
+      const NyxArchiveWriterData& data() const ;
+  };
+}
+#endif
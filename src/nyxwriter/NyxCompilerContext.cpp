@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NyxCompilerContext.h"
+#include <glslang/Public/ShaderLang.h>
+#include <mutex>
+
+namespace nyx
+{
+  namespace
+  {
+    /** Structure containing the state shared by every compiler context of the process.
+     */
+    struct ContextState
+    {
+      std::mutex lock           ; ///< The lock to hold while setting up or tearing down the compiler.
+      unsigned   references = 0 ; ///< The amount of contexts holding the compiler.
+    };
+
+    /** Method to retrieve the state shared by every compiler context.
+     * It is created on first use, so contexts with static lifetimes can safely be created & destroyed around it.
+     * @return Reference to the shared state.
+     */
+    ContextState& state()
+    {
+      static ContextState context_state ;
+
+      return context_state ;
+    }
+  }
+
+  NyxCompilerContext::NyxCompilerContext()
+  {
+    NyxCompilerContext::acquire() ;
+  }
+
+  NyxCompilerContext::NyxCompilerContext( const NyxCompilerContext& context )
+  {
+    ( void )context ;
+    NyxCompilerContext::acquire() ;
+  }
+
+  NyxCompilerContext::~NyxCompilerContext()
+  {
+    NyxCompilerContext::release() ;
+  }
+
+  NyxCompilerContext& NyxCompilerContext::operator=( const NyxCompilerContext& context )
+  {
+    ( void )context ;
+    return *this ;
+  }
+
+  bool NyxCompilerContext::active()
+  {
+    std::lock_guard<std::mutex> lock( state().lock ) ;
+
+    return state().references != 0 ;
+  }
+
+  void NyxCompilerContext::acquire()
+  {
+    std::lock_guard<std::mutex> lock( state().lock ) ;
+
+    // GLSLang's own setup is not safe to run from several threads at once, so it only ever runs under the lock.
+    if( state().references++ == 0 ) glslang::InitializeProcess() ;
+  }
+
+  void NyxCompilerContext::release()
+  {
+    std::lock_guard<std::mutex> lock( state().lock ) ;
+
+    if( --state().references == 0 ) glslang::FinalizeProcess() ;
+  }
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2020 Jordan Hendl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NYX_COMPILER_CONTEXT_H
+#define NYX_COMPILER_CONTEXT_H
+
+namespace nyx
+{
+  /** Class to keep the shader compiler set up for as long as any object of it lives.
+   * The compiler is set up when the first object is created & torn down when the last one is destroyed, no matter which
+   * threads they live on. Every NyxWriter holds one, so writers can be used on any amount of threads at once.
+   * Setting the compiler up is costly, so a process that keeps creating writers should hold an object of its own for as
+   * long as it compiles anything, to keep the compiler from being torn down in between writers.
+   */
+  class NyxCompilerContext
+  {
+    public:
+
+      /** Default Constructor. Sets up the compiler if no other object holds it.
+       */
+      NyxCompilerContext() ;
+
+      /** Copy Constructor. Holds the compiler set up as well.
+       * @param context The object to copy.
+       */
+      NyxCompilerContext( const NyxCompilerContext& context ) ;
+
+      /** Default Deconstructor. Tears down the compiler if this was the last object holding it.
+       */
+      ~NyxCompilerContext() ;
+
+      /** Assignment operator. Both objects already hold the compiler, so this does nothing.
+       * @param context The object to assign this one to.
+       * @return Reference to this object after assignment.
+       */
+      NyxCompilerContext& operator=( const NyxCompilerContext& context ) ;
+
+      /** Method to retrieve whether the compiler is set up.
+       * @return Whether or not any object currently holds the compiler.
+       */
+      static bool active() ;
+
+    private:
+
+      /** Method to hold the compiler, setting it up if nothing else holds it.
+       */
+      static void acquire() ;
+
+      /** Method to stop holding the compiler, tearing it down if nothing else holds it.
+       */
+      static void release() ;
+  };
+}
+#endif
@@ -16,7 +16,12 @@
  */
 
 #include "NyxWriter.h"
+#include "NyxCompilerContext.h"
+#include "AtomicFile.h"
 #include <nyxfile/NyxFile.h>
+#include <nyxfile/NyxFileBuilder.h>
+#include <nyxfile/NyxFormat.h>
+#include <nyxfile/SpirvCodec.h>
 #include <glslang/Public/ShaderLang.h>
 #include <glslang/SPIRV/GlslangToSpv.h>
 #include <glslang/StandAlone/DirStackFileIncluder.h>
@@ -30,18 +35,28 @@
 #include <cerrno>
 #include <memory>
 #include <algorithm>
+#include <cstring>
 #include <ctype.h>
 #include <map>
+#include <iomanip>
+#include <filesystem>
+#include <thread>
+#include <atomic>
 #include <limits.h>
 #include <stdlib.h>
 
 namespace nyx
 {
-  struct Shader ;
+  // The reader has its own structures by these names, so these are kept internal to not clash with them when linked together.
+  namespace
+  {
+    struct Shader ;
+  }
+
   typedef std::map<ShaderStage, Shader> ShaderMap ;
 
-  constexpr unsigned long long MAGIC           = 0x555755200d0a ;
-  constexpr unsigned           NYXFILE_VERSION = 1              ;
+  constexpr unsigned CACHE_MAGIC   = 0x4358594e ; ///< "NYXC", the start of every cached compilation.
+  constexpr unsigned CACHE_VERSION = 3          ; ///< The version of what the writer caches, to be bumped whenever that changes.
 
   const static constexpr TBuiltInResource DefaultTBuiltInResource = 
   {
@@ -166,6 +181,66 @@ namespace nyx
    */
   static inline unsigned sizeFromType( std::string type_name ) ;
 
+  /** Method to retrieve the descriptor set a uniform was declared in.
+   * @param type The GLSLang type of the uniform.
+   * @return The set of the uniform's layout qualifier, or 0 if it has none.
+   */
+  static unsigned setOf( const glslang::TType& type ) ;
+
+  /** Method to retrieve the amount of descriptors a uniform takes up.
+   * @param type The GLSLang type of the uniform.
+   * @return The declared size of the uniform if it is a sized array, or 1 otherwise.
+   */
+  static unsigned countOf( const glslang::TType& type ) ;
+
+  unsigned setOf( const glslang::TType& type )
+  {
+    return type.getQualifier().hasSet() ? type.getQualifier().layoutSet : 0 ;
+  }
+
+  /** Method to retrieve the size of a single component of a type.
+   * @param type The GLSLang type to look up.
+   * @return The size in bytes of one of the type's scalars.
+   */
+  static unsigned componentSizeOf( const glslang::TType& type ) ;
+
+  /** Method to retrieve the vertex format of a single column of a type.
+   * @param type The GLSLang type to look up.
+   * @return The VertexFormat one location of the type is read as.
+   */
+  static unsigned formatOf( const glslang::TType& type ) ;
+
+  unsigned countOf( const glslang::TType& type )
+  {
+    return type.isSizedArray() ? static_cast<unsigned>( type.getOuterArraySize() ) : 1 ;
+  }
+
+  unsigned componentSizeOf( const glslang::TType& type )
+  {
+    return type.getBasicType() == glslang::EbtDouble ? sizeof( double ) : sizeof( float ) ;
+  }
+
+  unsigned formatOf( const glslang::TType& type )
+  {
+    const unsigned rows = type.isMatrix() ? type.getMatrixRows() : type.getVectorSize() ;
+
+    static const unsigned floats [] = { R32_Sfloat, R32G32_Sfloat, R32G32B32_Sfloat, R32G32B32A32_Sfloat } ;
+    static const unsigned ints   [] = { R32_Sint  , R32G32_Sint  , R32G32B32_Sint  , R32G32B32A32_Sint   } ;
+    static const unsigned uints  [] = { R32_Uint  , R32G32_Uint  , R32G32B32_Uint  , R32G32B32A32_Uint   } ;
+    static const unsigned doubles[] = { R64_Sfloat, R64G64_Sfloat, R64G64B64_Sfloat, R64G64B64A64_Sfloat } ;
+
+    if( rows < 1 || rows > 4 ) return VertexFormat::Undefined ;
+
+    switch( type.getBasicType() )
+    {
+      case glslang::EbtFloat  : return floats [ rows - 1 ] ;
+      case glslang::EbtInt    : return ints   [ rows - 1 ] ;
+      case glslang::EbtUint   : return uints  [ rows - 1 ] ;
+      case glslang::EbtDouble : return doubles[ rows - 1 ] ;
+      default                 : return VertexFormat::Undefined ;
+    }
+  }
+
   unsigned sizeFromType( std::string type_name )
   {
          if( type_name == "mat4"     ) return sizeof( float    ) * 16 ;
@@ -184,63 +259,185 @@ namespace nyx
     else { std::cout << "Unknown type : " << type_name << std::endl ; exit( -1 ) ; } ;
   }
 
-  /** Structure to encompass a GLSL Uniform
-   */
-  struct Uniform
+  namespace
   {
-    unsigned    binding ;
-    unsigned    size    ;
-    UniformType type    ;
-    std::string name    ;
-  };
+    /** Structure to encompass a GLSL Uniform
+     */
+    struct Uniform
+    {
+      unsigned    set     ;
+      unsigned    binding ;
+      unsigned    size    ;
+      unsigned    count   ;
+      UniformType type    ;
+      std::string name    ;
+    };
+
+    /** Structure to encompass a GLSL Attribute.
+     */
+    struct Attribute
+    {
+      std::string name     ;
+      std::string type     ;
+      unsigned    size     ;
+      unsigned    location ;
+    };
 
-  /** Structure to encompass a GLSL Attribute.
-   */
-  struct Attribute
-  {
-    std::string name     ;
-    std::string type     ;
-    unsigned    size     ;
-    unsigned    location ;
-  };
+    /** Structure to encompass a single shader shader.
+     */
+    struct Shader
+    {
+      typedef std::vector<unsigned>   SpirVData     ;
+      typedef std::vector<Uniform>    UniformList   ;
 
-  /** Structure to encompass a single shader shader.
-   */
-  struct Shader
-  {
-    typedef std::vector<unsigned>   SpirVData     ;
-    typedef std::vector<Uniform>    UniformList   ;
+      UniformList   uniforms   ;
+      SpirVData     spirv      ;
+      ShaderStage   stage      ;
+      std::string   name       ;
+    };
 
-    UniformList   uniforms   ;
-    SpirVData     spirv      ;
-    ShaderStage   stage      ;
-    std::string   name       ;
-  };
+    /** Structure to encompass the compilation of a single shader stage, & everything it produced.
+     */
+    struct Compilation
+    {
+      typedef std::vector<Attribute>          AttributeList ;
+      typedef std::vector<NyxVertexAttribute> VertexList    ;
+      typedef std::vector<std::string>        PathList      ;
+
+      ShaderStage   stage                     ;
+      std::string   source                    ; ///< The GLSL of the stage, copied as the caller's only lives through compile().
+      Shader        shader                    ;
+      AttributeList inputs                    ;
+      AttributeList outputs                   ;
+      VertexList    vertex_attributes         ;
+      unsigned      vertex_stride     = 0     ;
+      PathList      dependencies              ; ///< The path of every file the stage included.
+      std::string   log                       ; ///< Why the stage failed to compile, if it did.
+      bool          compiled          = false ;
+    };
+
+    /** Structure to intern every string of a .nyx file into a single, deduplicated section.
+     */
+    struct StringPool
+    {
+      std::map<std::string, unsigned> offsets ; ///< The offset of every interned string into the section.
+      std::vector<unsigned char>      bytes   ; ///< The section's bytes, each string followed by a terminator.
 
-  /** Structure containing the data of a shader iterator.
-   */
-  struct ShaderIteratorData
-  {
-    ShaderMap::const_iterator it ;
-  };
+      /** Method to intern a string.
+       * @param str The string to intern.
+       * @return The offset of the string inside of the section.
+       */
+      unsigned intern( const std::string& str ) ;
+    };
+
+    /** Structure to include files the same way GLSLang's own includer does, while recording every file it included.
+     */
+    struct TrackingIncluder : public DirStackFileIncluder
+    {
+      std::vector<std::string> included ; ///< The path of every file included, in the order they were first included.
+
+      IncludeResult* includeLocal ( const char* header_name, const char* includer_name, size_t depth ) override ;
+      IncludeResult* includeSystem( const char* header_name, const char* includer_name, size_t depth ) override ;
+
+      /** Method to record the file of an include, if it was found.
+       * @param result The result of including the file, or nullptr if it was not found.
+       * @return The input result.
+       */
+      IncludeResult* record( IncludeResult* result ) ;
+    };
+
+    /** Structure to read the values of a cached compilation back, without reading past their end.
+     */
+    struct CacheReader
+    {
+      const unsigned char* ptr  ; ///< The next byte to read.
+      const unsigned char* end  ; ///< One past the last byte that can be read.
+      bool                 good ; ///< Whether every value so far could be read.
+
+      /** Method to read an unsigned integer.
+       * @return The integer read, or 0 if there are not enough bytes left.
+       */
+      unsigned readUnsigned() ;
+
+      /** Method to read a string written by NyxWriterData::writeString.
+       * @return The string read, or an empty one if there are not enough bytes left.
+       */
+      std::string readString() ;
+    };
+
+    /** Structure containing the data of a shader iterator.
+     */
+    struct ShaderIteratorData
+    {
+      ShaderMap::const_iterator it ;
+    };
+  }
 
   struct NyxWriterData
   {
-    typedef std::vector<Attribute>  AttributeList ;
-    
+    typedef std::vector<Attribute>          AttributeList ;
+    typedef std::vector<NyxVertexAttribute> VertexList    ;
+    typedef std::vector<unsigned char>      Bytes         ;
+    typedef std::vector<std::string>        PathList      ;
+
+    NyxCompilerContext       context ; ///< Keeps the compiler set up for as long as this writer lives.
+    std::vector<Compilation> pending ; ///< The stages waiting on finish() to be compiled, in the order they were given.
+
     std::string   include_directory ; ///< The include directory for the shaders being compiled.
+    std::string   cache_directory   ; ///< The directory compiled stages are cached in, or empty to not cache them.
+    Bytes         saved             ; ///< The bytes of the file last put together by NyxWriter::saveToBytes().
+    PathList      dependencies      ; ///< The path of every file included by the compiled stages, each only once.
     ShaderMap     map               ; ///< The map of shader types to shader stages.
     AttributeList inputs            ;
     AttributeList outputs           ;
+    VertexList    vertex_attributes     ; ///< The attributes of the vertex stage's inputs, sorted by location.
+    unsigned      vertex_stride     = 0 ; ///< The size in bytes of a single vertex with every attribute interleaved.
 
     bool          build_debug       = true  ;
     bool          optimize_size     = false ;
+    bool          compress_spirv    = false ;
     
-    /** Method to load a shader.
-     * @param data The byte data of the GLSL shader.
-     * @param type The type of shader being loaded.
+    /** Method to compile a single shader stage. Only reads this object, so any amount of stages can compile at once.
+     * @param compilation The stage to compile, which receives everything the compilation produced.
+     */
+    void compileShader( Compilation& compilation ) const ;
+
+    /** Method to retrieve what identifies a compilation of a shader stage.
+     * @param compilation The stage being compiled.
+     * @param preprocessed The fully preprocessed GLSL of the stage.
+     * @return Everything the result of compiling the stage depends on.
+     */
+    std::string cacheKey( const Compilation& compilation, const std::string& preprocessed ) const ;
+
+    /** Method to retrieve the path a compilation is cached at.
+     * @param key The cacheKey() of the compilation.
+     * @return The path on the filesystem of the compilation's entry in the cache directory.
+     */
+    std::string cachePath( const std::string& key ) const ;
+
+    /** Method to load a compilation out of the cache.
+     * @param key The cacheKey() of the compilation.
+     * @param compilation The stage to load the compiled SPIRV & reflection into.
+     * @return Whether or not the cache had the compilation. If not, the stage is left as it was.
      */
-    void loadShader( const char* data, ShaderStage type ) ;
+    bool loadCached( const std::string& key, Compilation& compilation ) const ;
+
+    /** Method to store a compilation in the cache. Failing to do so is not an error, it only leaves the cache without it.
+     * The entry is written to a temporary file first, so other processes sharing the cache never see it half written.
+     * @param key The cacheKey() of the compilation.
+     * @param compilation The compiled stage to store.
+     */
+    void saveCached( const std::string& key, const Compilation& compilation ) const ;
+
+    /** Method to put together the .nyx file of every shader stage added to this object.
+     * @param bytes The vector to put the file's bytes in, replacing whatever it held.
+     */
+    void serialize( Bytes& bytes ) const ;
+
+    /** Method to compile every pending shader stage concurrently, then add them to this object in the order they were given.
+     * Exits if any of them failed to compile, after reporting the first one that did.
+     */
+    void finish() ;
 
     /** Method to parse attributes from a GLSL shader.
      * @param data The byte data of the GLSL shader to parse.
@@ -248,44 +445,87 @@ namespace nyx
      */
     void parseAttributes( const char* data, ShaderStage stage ) ;
     
-    void parseAttributes( Shader& shader, glslang::TProgram& program ) ;
+    void parseAttributes( Compilation& compilation, glslang::TProgram& program ) const ;
+
+    /** Method to lay out the inputs of a vertex shader as attributes interleaved into a single vertex.
+     * @param compilation The compilation of the vertex shader to store the layout into.
+     * @param program The GLSL program of the vertex shader, with its reflection built.
+     */
+    void layoutVertexInput( Compilation& compilation, glslang::TProgram& program ) const ;
     
     /** Method to generate descriptor set information for each shader.
      * @param map The shader map to store the uniform information into.
      * @param program The GLSL program to use for GLSL uniform reflection.
      */
-    void generateDescriptorSetBindings( Shader& map, glslang::TProgram& program ) ;
+    void generateDescriptorSetBindings( Shader& map, glslang::TProgram& program ) const ;
 
-    /** Method to write a string out to a file stream.
-     * @param stream The stream to write to.
+    /** Method to write a string out to a byte buffer.
+     * @param bytes The buffer to append to.
      * @param str The string to write.
      */
-    void writeString( std::ofstream& stream, std::string str ) const ;
+    void writeString( Bytes& bytes, std::string str ) const ;
 
-    /** Method to write an unsigned integer to a file stream.
-     * @param stream The stream to write to.
+    /** Method to write a string out to a byte buffer as a reference into a string pool.
+     * @param bytes The buffer to append to.
+     * @param pool The pool to intern the string into.
+     * @param str The string to write.
+     */
+    void writeString( Bytes& bytes, StringPool& pool, const std::string& str ) const ;
+
+    /** Method to write an unsigned integer to a byte buffer.
+     * @param bytes The buffer to append to.
      * @param num The integer to write out.
      */
-    void writeUnsigned( std::ofstream& stream, unsigned num ) const ;
+    void writeUnsigned( Bytes& bytes, unsigned num ) const ;
 
-    /** Method to write a boolean value to a file stream.
-     * @param stream The stream to write to.
+    /** Method to write a boolean value to a byte buffer.
+     * @param bytes The buffer to append to.
      * @param val The boolean value to write.
      */
-    void writeBoolean( std::ofstream& stream, bool val ) const ;
+    void writeBoolean( Bytes& bytes, bool val ) const ;
 
-    /** Method to write the file's magic number to a file stream.
-     * @param stream The stream to write to.
-     * @param magic The magic number to write.
+    /** Method to write a stream of bytes ( SPIRV ) to a byte buffer.
+     * @param bytes The buffer to append to.
+     * @param sz The amount of words in the compiled SPIRV to write.
+     * @param spirv The pointer to the SPIRV data.
      */
-    void writeMagic( std::ofstream& stream, unsigned long long magic ) const ;
+    void writeSpirv( Bytes& bytes, unsigned sz, const unsigned* spirv ) const ;
 
-    /** Method to write a stream of bytes ( SPIRV ) to a file stream.
-     * @param stream The stream to write to.
-     * @param sz The amount of bytes in the compiled SPIRV to write.
+    /** Method to write compressed SPIRV to a byte buffer.
+     * @param bytes The buffer to append to.
+     * @param sz The amount of words in the compiled SPIRV to write.
      * @param spirv The pointer to the SPIRV data.
+     * @return Whether or not the SPIRV could be compressed. If not, nothing was written.
+     */
+    bool writeCompressedSpirv( Bytes& bytes, unsigned sz, const unsigned* spirv ) const ;
+
+    /** Method to write a list of attributes to a byte buffer.
+     * @param bytes The buffer to append to.
+     * @param pool The pool to intern the attributes' strings into.
+     * @param attributes The attributes to write.
      */
-    void writeSpirv( std::ofstream& stream, unsigned sz, const unsigned* spirv ) const ;
+    void writeAttributes( Bytes& bytes, StringPool& pool, const AttributeList& attributes ) const ;
+
+    /** Method to write a table to look up names by, in the order they were written, to a byte buffer.
+     * @param bytes The buffer to append to.
+     * @param names The names to look up.
+     */
+    void writeNameTable( Bytes& bytes, const std::vector<std::string>& names ) const ;
+
+    /** Method to merge the descriptor bindings of every shader stage.
+     * @return The merged bindings, sorted by set and binding.
+     */
+    std::vector<NyxBinding> mergeBindings() const ;
+
+    /** Method to write the descriptor bindings of every shader stage, merged & sorted by set and binding, to a byte buffer.
+     * @param bytes The buffer to append to.
+     */
+    void writeBindings( Bytes& bytes ) const ;
+
+    /** Method to write the vertex input layout of the vertex stage to a byte buffer.
+     * @param bytes The buffer to append to.
+     */
+    void writeVertexInput( Bytes& bytes ) const ;
   };
 
   void operator<<( EShLanguage& eshlang, const ShaderStage& stage )
@@ -315,91 +555,259 @@ namespace nyx
       default                    : str = ""                     ; break ;
     }
   }
-  void NyxWriterData::parseAttributes( Shader& shader, glslang::TProgram& program )
+  /** Method to describe a pipeline input or output as an attribute.
+   * @param object The GLSLang reflection of the input or output.
+   * @return The attribute, with its type name, its size in bytes & its declared location.
+   */
+  static Attribute attributeOf( const glslang::TObjectReflection& object ) ;
+
+  Attribute attributeOf( const glslang::TObjectReflection& object )
   {
-    Attribute attribute ;
-    
-    for( unsigned index = 0; index < program.getNumPipeInputs(); index++ )
+    const auto&       type = *object.getType() ;
+    std::stringstream str                      ;
+    Attribute         attribute                ;
+    unsigned          components               ;
+
+    switch( type.getBasicType() )
     {
-      std::stringstream str ;
-      auto& input = program.getPipeInput( index ) ;
-      auto* type  = input.getType()               ;
-      
-      if( type->isVector() )
-      { 
-        str << "vec"                 ;
-        str << type->getVectorSize() ;
-      }
-      else if( type->isMatrix() )
-      {
-        str << "mat"                 ;
-        str << type->getMatrixRows() ;
-      }
+      case glslang::EbtInt    : str << ( type.isScalar() ? "int"    : "i" ) ; break ;
+      case glslang::EbtUint   : str << ( type.isScalar() ? "uint"   : "u" ) ; break ;
+      case glslang::EbtDouble : str << ( type.isScalar() ? "double" : "d" ) ; break ;
+      case glslang::EbtBool   : str << ( type.isScalar() ? "bool"   : "b" ) ; break ;
+      default                 : str << ( type.isScalar() ? "float"  : ""  ) ; break ;
+    }
 
-      attribute.location = input.index                             ;
-      attribute.name     = input.name                              ;
-      attribute.size     = type->getVectorSize() * sizeof( float ) ;
-      attribute.type     = str.str()                               ;
-      
-      this->inputs.push_back( attribute ) ;
+    if( type.isVector() )
+    {
+      str << "vec"                ;
+      str << type.getVectorSize() ;
+    }
+    else if( type.isMatrix() )
+    {
+      str << "mat"                ;
+      str << type.getMatrixCols() ;
+      if( type.getMatrixCols() != type.getMatrixRows() ) str << "x" << type.getMatrixRows() ;
+    }
+
+    components = type.isMatrix() ? type.getMatrixCols() * type.getMatrixRows() : type.getVectorSize() ;
+    if( type.isSizedArray() ) components *= type.getCumulativeArraySize() ;
+
+    attribute.location = type.getQualifier().hasLocation() ? type.getQualifier().layoutLocation : 0 ;
+    attribute.name     = object.name                                                                ;
+    attribute.size     = components * componentSizeOf( type )                                       ;
+    attribute.type     = str.str()                                                                  ;
+
+    return attribute ;
+  }
+
+  void NyxWriterData::parseAttributes( Compilation& compilation, glslang::TProgram& program ) const
+  {
+    for( unsigned index = 0; index < program.getNumPipeInputs(); index++ )
+    {
+      compilation.inputs.push_back( attributeOf( program.getPipeInput( index ) ) ) ;
     }
     
     for( unsigned index = 0; index < program.getNumPipeOutputs(); index++ )
     {
-      std::stringstream str ;
-      auto& output = program.getPipeOutput( index ) ;
-      auto* type   = output.getType()               ;
-      
-      if( type->isVector() )
-      { 
-        str << "vec"                 ;
-        str << type->getVectorSize() ;
-      }
-      else if( type->isMatrix() )
+      compilation.outputs.push_back( attributeOf( program.getPipeOutput( index ) ) ) ;
+    }
+
+    if( compilation.stage == ShaderStage::Vertex ) this->layoutVertexInput( compilation, program ) ;
+  }
+
+  void NyxWriterData::layoutVertexInput( Compilation& compilation, glslang::TProgram& program ) const
+  {
+    struct Location
+    {
+      NyxVertexAttribute attribute ;
+      unsigned           size      ;
+      unsigned           alignment ;
+    };
+
+    std::vector<Location> locations ;
+    unsigned              offset    ;
+    unsigned              alignment ;
+
+    for( int index = 0; index < program.getNumPipeInputs(); index++ )
+    {
+      const auto& type = *program.getPipeInput( index ).getType() ;
+
+      if( type.isBuiltIn() ) continue ;
+
+      const unsigned component = componentSizeOf( type )                                                         ;
+      const unsigned rows      = type.isMatrix() ? type.getMatrixRows() : type.getVectorSize()                   ;
+      const unsigned columns   = type.isMatrix() ? type.getMatrixCols() : 1                                      ;
+      const unsigned elements  = type.isSizedArray() ? type.getCumulativeArraySize() : 1                         ;
+      const unsigned first     = type.getQualifier().hasLocation() ? type.getQualifier().layoutLocation : 0      ;
+      const unsigned span      = component * rows > 16 ? 2 : 1                                                   ;
+      const unsigned format    = formatOf( type )                                                                ;
+
+      // Every column of every element of a matrix or array is an attribute of its own, at a location of its own.
+      for( unsigned column = 0; column < elements * columns; column++ )
       {
-        str << "mat"                 ;
-        str << type->getMatrixRows() ;
+        locations.push_back( { { first + column * span, 0, format, 0 }, component * rows, component } ) ;
       }
-      
-      attribute.location = output.index                            ;
-      attribute.name     = output.name                             ;
-      attribute.size     = type->getVectorSize() * sizeof( float ) ;
-      attribute.type     = str.str()                               ;
+    }
 
-      this->outputs.push_back( attribute ) ;
+    std::sort( locations.begin(), locations.end(), []( const Location& a, const Location& b ) { return a.attribute.location < b.attribute.location ; } ) ;
+
+    // Attributes are interleaved in location order, each aligned to the size of its components.
+    offset    = 0 ;
+    alignment = 1 ;
+    compilation.vertex_attributes.clear() ;
+    for( auto& location : locations )
+    {
+      offset                      = ( offset + location.alignment - 1 ) / location.alignment * location.alignment ;
+      location.attribute.offset   = offset                                                                        ;
+      offset                     += location.size                                                                 ;
+      alignment                   = std::max( alignment, location.alignment )                                     ;
+
+      compilation.vertex_attributes.push_back( location.attribute ) ;
     }
+
+    compilation.vertex_stride = ( offset + alignment - 1 ) / alignment * alignment ;
+  }
+
+  unsigned StringPool::intern( const std::string& str )
+  {
+    auto iter = this->offsets.find( str ) ;
+
+    if( iter == this->offsets.end() )
+    {
+      iter = this->offsets.insert( { str, this->bytes.size() } ).first ;
+      this->bytes.insert( this->bytes.end(), str.begin(), str.end() ) ;
+      this->bytes.push_back( '\0' ) ;
+    }
+
+    return iter->second ;
+  }
+
+  void NyxWriterData::writeString( Bytes& bytes, std::string val ) const
+  {
+    this->writeUnsigned( bytes, val.size() ) ;
+    bytes.insert( bytes.end(), val.begin(), val.end() ) ;
+  }
+
+  void NyxWriterData::writeString( Bytes& bytes, StringPool& pool, const std::string& val ) const
+  {
+    this->writeUnsigned( bytes, pool.intern( val ) ) ;
   }
 
-  void NyxWriterData::writeString( std::ofstream& stream, std::string val ) const
+  void NyxWriterData::writeUnsigned( Bytes& bytes, unsigned val ) const
   {
-    unsigned sz ;
+    const unsigned char* ptr = reinterpret_cast<const unsigned char*>( &val ) ;
+    bytes.insert( bytes.end(), ptr, ptr + sizeof( unsigned ) ) ;
+  }
 
-    sz = val.size() ;
-    stream.write( (char*)&sz, sizeof( unsigned ) ) ;
-    stream.write( (char*)&val[0], sz             ) ;
+  void NyxWriterData::writeBoolean( Bytes& bytes, bool val ) const
+  {
+    const unsigned char* ptr = reinterpret_cast<const unsigned char*>( &val ) ;
+    bytes.insert( bytes.end(), ptr, ptr + sizeof( bool ) ) ;
   }
 
-  void NyxWriterData::writeMagic( std::ofstream& stream, unsigned long long val ) const
+  void NyxWriterData::writeSpirv( Bytes& bytes, unsigned sz, const unsigned* spirv ) const
   {
-    stream.write( (char*)&val, sizeof( unsigned long long ) ) ;
+    const unsigned char* ptr = reinterpret_cast<const unsigned char*>( spirv ) ;
+    bytes.insert( bytes.end(), ptr, ptr + sz * sizeof( unsigned ) ) ;
   }
 
-  void NyxWriterData::writeUnsigned( std::ofstream& stream, unsigned val ) const
+  bool NyxWriterData::writeCompressedSpirv( Bytes& bytes, unsigned sz, const unsigned* spirv ) const
   {
-    stream.write( (char*)&val, sizeof( unsigned ) ) ;
+    const unsigned long long start = bytes.size() ;
+    unsigned long long       size                 ;
+
+    this->writeUnsigned( bytes, sz ) ;
+    bytes.resize( bytes.size() + spirvEncodeBound( sz ) ) ;
+
+    size = encodeSpirv( spirv, sz, bytes.data() + start + sizeof( unsigned ) ) ;
+    bytes.resize( size != 0 ? start + sizeof( unsigned ) + size : start ) ;
+
+    return size != 0 ;
+  }
+
+  void NyxWriterData::writeAttributes( Bytes& bytes, StringPool& pool, const AttributeList& attributes ) const
+  {
+    for( const auto& attribute : attributes )
+    {
+      this->writeString  ( bytes, pool, attribute.name ) ;
+      this->writeString  ( bytes, pool, attribute.type ) ;
+      this->writeUnsigned( bytes, attribute.size     ) ;
+      this->writeUnsigned( bytes, attribute.location ) ;
+    }
+  }
+
+  void NyxWriterData::writeNameTable( Bytes& bytes, const std::vector<std::string>& names ) const
+  {
+    std::vector<NyxNameBucket> buckets( nameBuckets( names.size() ), NyxNameBucket{ 0, 0 } ) ;
+
+    for( unsigned index = 0; index < names.size(); index++ )
+    {
+      insertName( buckets.data(), buckets.size(), hashName( names[ index ].c_str() ), index ) ;
+    }
+
+    this->writeUnsigned( bytes, buckets.size() ) ;
+    this->writeUnsigned( bytes, 0              ) ;
+    for( const auto& bucket : buckets )
+    {
+      this->writeUnsigned( bytes, bucket.hash  ) ;
+      this->writeUnsigned( bytes, bucket.index ) ;
+    }
+  }
+
+  std::vector<NyxBinding> NyxWriterData::mergeBindings() const
+  {
+    std::map<std::pair<unsigned, unsigned>, NyxBinding> merged   ;
+    std::vector<NyxBinding>                             bindings ;
+
+    for( const auto& shader : this->map )
+    {
+      for( const auto& uniform : shader.second.uniforms )
+      {
+        const auto key  = std::make_pair( uniform.set, uniform.binding ) ;
+        auto       iter = merged.emplace( key, NyxBinding{ uniform.set, uniform.binding, uniform.type, uniform.count, 0 } ).first ;
+
+        // Stages declaring the same binding share it, so it has to hold as many descriptors as any of them uses.
+        iter->second.count   = std::max( iter->second.count, uniform.count ) ;
+        iter->second.stages |= 1u << shader.second.stage                     ;
+      }
+    }
+
+    bindings.reserve( merged.size() ) ;
+    for( const auto& entry : merged ) bindings.push_back( entry.second ) ;
+
+    return bindings ;
   }
 
-  void NyxWriterData::writeBoolean( std::ofstream& stream, bool val ) const
+  void NyxWriterData::writeBindings( Bytes& bytes ) const
   {
-    stream.write( (char*)&val, sizeof( bool ) ) ;
+    const std::vector<NyxBinding> merged = this->mergeBindings() ;
+
+    this->writeUnsigned( bytes, merged.size() ) ;
+    this->writeUnsigned( bytes, 0             ) ;
+    for( const auto& binding : merged )
+    {
+      this->writeUnsigned( bytes, binding.set     ) ;
+      this->writeUnsigned( bytes, binding.binding ) ;
+      this->writeUnsigned( bytes, binding.type    ) ;
+      this->writeUnsigned( bytes, binding.count   ) ;
+      this->writeUnsigned( bytes, binding.stages  ) ;
+    }
   }
 
-  void NyxWriterData::writeSpirv( std::ofstream& stream, unsigned sz, const unsigned* spirv ) const
+  void NyxWriterData::writeVertexInput( Bytes& bytes ) const
   {
-    stream.write( (char*)spirv, sz * sizeof( unsigned ) ) ;
+    this->writeUnsigned( bytes, this->vertex_attributes.size() ) ;
+    this->writeUnsigned( bytes, this->vertex_stride            ) ;
+    for( const auto& attribute : this->vertex_attributes )
+    {
+      this->writeUnsigned( bytes, attribute.location ) ;
+      this->writeUnsigned( bytes, attribute.binding  ) ;
+      this->writeUnsigned( bytes, attribute.format   ) ;
+      this->writeUnsigned( bytes, attribute.offset   ) ;
+    }
   }
 
-  void NyxWriterData::generateDescriptorSetBindings( Shader& shader, glslang::TProgram& program )
+  void NyxWriterData::generateDescriptorSetBindings( Shader& shader, glslang::TProgram& program ) const
   {
     std::string name    ; 
     Uniform     uniform ;
@@ -409,20 +817,24 @@ namespace nyx
       name = std::string( program.getUniformTType( i )->getCompleteString().c_str() ) ;
       if( name.find( "sampler2D" ) != std::string::npos )
       {
-        uniform.name    = program.getUniformName( i )      ;
-        uniform.binding = program.getUniformBinding( i )   ;
-        uniform.size    = program.getUniformArraySize( i ) ;
-        uniform.type    = UniformType::SAMPLER             ;
+        uniform.name    = program.getUniformName( i )              ;
+        uniform.set     = setOf  ( *program.getUniformTType( i ) ) ;
+        uniform.count   = countOf( *program.getUniformTType( i ) ) ;
+        uniform.binding = program.getUniformBinding( i )           ;
+        uniform.size    = program.getUniformArraySize( i )         ;
+        uniform.type    = UniformType::SAMPLER                     ;
 
         shader.uniforms.push_back( uniform ) ;
       }
 
       if( name.find( "image" ) != std::string::npos )
       {
-        uniform.name    = program.getUniformName( i )      ;
-        uniform.binding = program.getUniformBinding( i )   ;
-        uniform.size    = program.getUniformArraySize( i ) ;
-        uniform.type    = UniformType::IMAGE               ;
+        uniform.name    = program.getUniformName( i )              ;
+        uniform.set     = setOf  ( *program.getUniformTType( i ) ) ;
+        uniform.count   = countOf( *program.getUniformTType( i ) ) ;
+        uniform.binding = program.getUniformBinding( i )           ;
+        uniform.size    = program.getUniformArraySize( i )         ;
+        uniform.type    = UniformType::IMAGE                       ;
 
         shader.uniforms.push_back( uniform ) ;
       }
@@ -435,6 +847,8 @@ namespace nyx
       name = program.getUniformBlockName( i ) ;
 
       uniform.name    = name                                                                                           ;
+      uniform.set     = setOf  ( *program.getUniformBlock( i ).getType() )                                             ;
+      uniform.count   = countOf( *program.getUniformBlock( i ).getType() )                                             ;
       uniform.binding = program.getUniformBlockBinding( i )                                                            ;
       uniform.size    = complete_string.find( " buffer " ) != std::string::npos ? 1 : program.getUniformArraySize( i ) ;
       uniform.type    = complete_string.find( " buffer " ) != std::string::npos ? UniformType::SSBO : UniformType::UBO ;
@@ -446,89 +860,343 @@ namespace nyx
     }
   }
 
-  void NyxWriterData::loadShader( const char* data, ShaderStage type )
+  TrackingIncluder::IncludeResult* TrackingIncluder::includeLocal( const char* header_name, const char* includer_name, size_t depth )
+  {
+    return this->record( DirStackFileIncluder::includeLocal( header_name, includer_name, depth ) ) ;
+  }
+
+  TrackingIncluder::IncludeResult* TrackingIncluder::includeSystem( const char* header_name, const char* includer_name, size_t depth )
+  {
+    return this->record( DirStackFileIncluder::includeSystem( header_name, includer_name, depth ) ) ;
+  }
+
+  TrackingIncluder::IncludeResult* TrackingIncluder::record( IncludeResult* result )
+  {
+    if( result && std::find( this->included.begin(), this->included.end(), result->headerName ) == this->included.end() )
+    {
+      this->included.push_back( result->headerName ) ;
+    }
+
+    return result ;
+  }
+
+  unsigned CacheReader::readUnsigned()
+  {
+    unsigned val = 0 ;
+
+    if( this->end - this->ptr < static_cast<long>( sizeof( unsigned ) ) ) { this->good = false ; return 0 ; }
+
+    memcpy( &val, this->ptr, sizeof( unsigned ) ) ;
+    this->ptr += sizeof( unsigned ) ;
+    return val ;
+  }
+
+  std::string CacheReader::readString()
+  {
+    const unsigned size = this->readUnsigned() ;
+    std::string    val                         ;
+
+    if( static_cast<unsigned long>( this->end - this->ptr ) < size ) { this->good = false ; return val ; }
+
+    val.assign( reinterpret_cast<const char*>( this->ptr ), size ) ;
+    this->ptr += size ;
+    return val ;
+  }
+
+  std::string NyxWriterData::cacheKey( const Compilation& compilation, const std::string& preprocessed ) const
+  {
+    std::stringstream key ;
+
+    // Anything that changes what the compiler produces has to be part of the key, the writer's own layout included.
+    key << "nyx " << CACHE_VERSION << " " << NYXFILE_VERSION << " glslang " << glslang::GetKhronosToolId() << " " << glslang::GetSpirvGeneratorVersion() ;
+    key << " stage " << compilation.stage << " debug " << this->build_debug << " size " << this->optimize_size << "\n" ;
+    key << preprocessed ;
+
+    return key.str() ;
+  }
+
+  std::string NyxWriterData::cachePath( const std::string& key ) const
+  {
+    std::stringstream  path ;
+    unsigned long long hash ;
+
+    // 64 bit FNV-1a, to name the entry after its contents.
+    hash = 14695981039346656037ull ;
+    for( unsigned char ch : key )
+    {
+      hash ^= ch               ;
+      hash *= 1099511628211ull ;
+    }
+
+    path << this->cache_directory << "/" << std::hex << std::setw( 16 ) << std::setfill( '0' ) << hash << ".nyxc" ;
+    return path.str() ;
+  }
+
+  bool NyxWriterData::loadCached( const std::string& key, Compilation& compilation ) const
+  {
+    std::ifstream stream ;
+    Bytes         bytes  ;
+    CacheReader   reader ;
+    Compilation   cached ;
+
+    stream.open( this->cachePath( key ), std::ios::binary ) ;
+    if( !stream ) return false ;
+
+    bytes.assign( ( std::istreambuf_iterator<char>( stream ) ), std::istreambuf_iterator<char>() ) ;
+    reader = { bytes.data(), bytes.data() + bytes.size(), true } ;
+
+    // Entries are named by a hash of their key, so the whole key is stored & compared as well to rule out a collision.
+    if( reader.readUnsigned() != CACHE_MAGIC ) return false ;
+    if( reader.readString()   != key         ) return false ;
+
+    cached.shader.spirv.resize( std::min<unsigned long>( reader.readUnsigned(), bytes.size() / sizeof( unsigned ) ) ) ;
+    for( auto& word : cached.shader.spirv ) word = reader.readUnsigned() ;
+
+    cached.shader.uniforms.resize( std::min<unsigned long>( reader.readUnsigned(), bytes.size() ) ) ;
+    for( auto& uniform : cached.shader.uniforms )
+    {
+      uniform.name    = reader.readString()                                ;
+      uniform.set     = reader.readUnsigned()                              ;
+      uniform.binding = reader.readUnsigned()                              ;
+      uniform.size    = reader.readUnsigned()                              ;
+      uniform.count   = reader.readUnsigned()                              ;
+      uniform.type    = static_cast<UniformType>( reader.readUnsigned() ) ;
+    }
+
+    for( auto* attributes : { &cached.inputs, &cached.outputs } )
+    {
+      attributes->resize( std::min<unsigned long>( reader.readUnsigned(), bytes.size() ) ) ;
+      for( auto& attribute : *attributes )
+      {
+        attribute.name     = reader.readString()   ;
+        attribute.type     = reader.readString()   ;
+        attribute.size     = reader.readUnsigned() ;
+        attribute.location = reader.readUnsigned() ;
+      }
+    }
+
+    cached.vertex_attributes.resize( std::min<unsigned long>( reader.readUnsigned(), bytes.size() ) ) ;
+    cached.vertex_stride = reader.readUnsigned() ;
+    for( auto& attribute : cached.vertex_attributes )
+    {
+      attribute.location = reader.readUnsigned() ;
+      attribute.binding  = reader.readUnsigned() ;
+      attribute.format   = reader.readUnsigned() ;
+      attribute.offset   = reader.readUnsigned() ;
+    }
+
+    if( !reader.good || reader.ptr != reader.end ) return false ;
+
+    compilation.shader            = std::move( cached.shader            ) ;
+    compilation.inputs            = std::move( cached.inputs            ) ;
+    compilation.outputs           = std::move( cached.outputs           ) ;
+    compilation.vertex_attributes = std::move( cached.vertex_attributes ) ;
+    compilation.vertex_stride     = cached.vertex_stride                  ;
+    compilation.shader.stage      = compilation.stage                     ;
+    return true ;
+  }
+
+  void NyxWriterData::saveCached( const std::string& key, const Compilation& compilation ) const
   {
-    static bool glslang_initialized = false ;
+    const std::string path = this->cachePath( key ) ;
+
+    std::error_code error ;
+    Bytes           bytes ;
+
+    this->writeUnsigned( bytes, CACHE_MAGIC ) ;
+    this->writeString  ( bytes, key         ) ;
+
+    this->writeUnsigned( bytes, compilation.shader.spirv.size() ) ;
+    this->writeSpirv   ( bytes, compilation.shader.spirv.size(), compilation.shader.spirv.data() ) ;
+
+    this->writeUnsigned( bytes, compilation.shader.uniforms.size() ) ;
+    for( const auto& uniform : compilation.shader.uniforms )
+    {
+      this->writeString  ( bytes, uniform.name    ) ;
+      this->writeUnsigned( bytes, uniform.set     ) ;
+      this->writeUnsigned( bytes, uniform.binding ) ;
+      this->writeUnsigned( bytes, uniform.size    ) ;
+      this->writeUnsigned( bytes, uniform.count   ) ;
+      this->writeUnsigned( bytes, uniform.type    ) ;
+    }
+
+    for( const auto* attributes : { &compilation.inputs, &compilation.outputs } )
+    {
+      this->writeUnsigned( bytes, attributes->size() ) ;
+      for( const auto& attribute : *attributes )
+      {
+        this->writeString  ( bytes, attribute.name     ) ;
+        this->writeString  ( bytes, attribute.type     ) ;
+        this->writeUnsigned( bytes, attribute.size     ) ;
+        this->writeUnsigned( bytes, attribute.location ) ;
+      }
+    }
+
+    this->writeUnsigned( bytes, compilation.vertex_attributes.size() ) ;
+    this->writeUnsigned( bytes, compilation.vertex_stride            ) ;
+    for( const auto& attribute : compilation.vertex_attributes )
+    {
+      this->writeUnsigned( bytes, attribute.location ) ;
+      this->writeUnsigned( bytes, attribute.binding  ) ;
+      this->writeUnsigned( bytes, attribute.format   ) ;
+      this->writeUnsigned( bytes, attribute.offset   ) ;
+    }
+
+    // Entries are checked when read back, so one torn by a crash is only a miss & is not worth waiting on the disk for.
+    std::filesystem::create_directories( this->cache_directory, error ) ;
+    writeAtomically( path.c_str(), bytes.data(), bytes.size(), false ) ;
+  }
 
+  void NyxWriterData::compileShader( Compilation& compilation ) const
+  {
     const int default_version = 100 ;
     const int input_version   = 100 ;
 
-    Shader                            shader         ;
+    const char*                       data           ;
     glslang::EshTargetClientVersion   vulkan_version ;
     glslang::TProgram                 program        ;
     glslang::EShTargetLanguageVersion glsl_version   ;
     glslang::SpvOptions               options        ;
     spv::SpvBuildLogger               logger         ;
-    std::string                       glsl_code      ;
+    std::stringstream                 log            ;
     std::string                       stage_name     ;
     std::string                       pre_processed  ;
+    std::string                       key            ;
     EShLanguage                       lang_type      ;
     TBuiltInResource                  resources      ;
     EShMessages                       messages       ;
-    DirStackFileIncluder              includer       ;
+    TrackingIncluder                  includer       ;
 
-    if( !glslang_initialized )
-    {
-      glslang::InitializeProcess() ;
-      glslang_initialized = true ;
-    }
     options.generateDebugInfo = this->build_debug   ;
     options.optimizeSize      = this->optimize_size ;
     options.validate          = true                ;
 
-    lang_type  << type ;
-    stage_name << type ;
+    lang_type  << compilation.stage ;
+    stage_name << compilation.stage ;
 
+    data           = compilation.source.c_str()                                     ;
     resources      = DefaultTBuiltInResource                                        ;
     vulkan_version = glslang::EShTargetVulkan_1_2                                   ;
     glsl_version   = glslang::EShTargetSpv_1_0                                      ;
     messages       = static_cast<EShMessages>( EShMsgSpvRules | EShMsgVulkanRules ) ;
 
+    auto setup = [ & ]( glslang::TShader& shader )
+    {
+      shader.setEnvInput ( glslang::EShSourceGlsl, lang_type, glslang::EShClientVulkan, input_version ) ;
+      shader.setEnvClient( glslang::EShClientVulkan, vulkan_version                                   ) ;
+      shader.setEnvTarget( glslang::EshTargetSpv, glsl_version                                        ) ;
+      shader.setStrings  ( &data, 1                                                                   ) ;
+    };
+
     // Why is there not default constructor for a TShader???? I cannot declare, then initialize. Must do both here. Ugh.
     glslang::TShader glslang_shader( lang_type ) ;
-    glslang_shader.setEnvInput ( glslang::EShSourceGlsl, lang_type, glslang::EShClientVulkan, input_version ) ;
-    glslang_shader.setEnvClient( glslang::EShClientVulkan, vulkan_version                                   ) ;
-    glslang_shader.setEnvTarget( glslang::EshTargetSpv, glsl_version                                        ) ;
-    glslang_shader.setStrings  ( &data, 1                                                                   ) ;
+    setup( glslang_shader ) ;
     includer.pushExternalLocalDirectory( this->include_directory.c_str() ) ;
 
-    if( !glslang_shader.preprocess( &resources, default_version, ENoProfile, false, false, messages, &pre_processed, includer ) )
+    // Stages whose preprocessed source was compiled before with the same settings are taken from the cache instead.
+    // Parsing preprocesses the source on its own, so the preprocessed text is only ever produced to look the cache up.
+    // That happens on a shader of its own, as a shader that was preprocessed embeds its source twice once parsed.
+    if( !this->cache_directory.empty() )
     {
-      std::cout << "GLSL Preprocessing Failed for: " << stage_name << std::endl ;
-      std::cout << glslang_shader.getInfoLog()                     << std::endl ;
-      std::cout << glslang_shader.getInfoDebugLog()                << std::endl ;
-      exit( -1 ) ;
-    }
+      glslang::TShader preprocessor( lang_type ) ;
+      setup( preprocessor ) ;
 
-    // For some reason i have to do this as well. I cannot just use the c_str() directly.
-    const char* preprocc = pre_processed.c_str() ;
-    glslang_shader.setStrings( &preprocc, 1 ) ;
+      if( !preprocessor.preprocess( &resources, default_version, ENoProfile, false, false, messages, &pre_processed, includer ) )
+      {
+        log << "GLSL Preprocessing Failed for: " << stage_name << std::endl ;
+        log << preprocessor.getInfoLog()                       << std::endl ;
+        log << preprocessor.getInfoDebugLog()                  << std::endl ;
+        compilation.log = log.str() ;
+        return ;
+      }
 
-    if( !glslang_shader.parse( &resources, default_version, false, messages ) )
+      key = this->cacheKey( compilation, pre_processed ) ;
+      if( this->loadCached( key, compilation ) )
+      {
+        compilation.dependencies = includer.included ;
+        compilation.compiled     = true              ;
+        return ;
+      }
+    }
+
+    // The original source is parsed even after a cache miss, so the SPIRV & its debug info never depend on the cache.
+    if( !glslang_shader.parse( &resources, default_version, ENoProfile, false, false, messages, includer ) )
     {
-      std::cout << "GLSL Parsing Failed for: " << stage_name << std::endl ;
-      std::cout << glslang_shader.getInfoLog()               << std::endl ;
-      std::cout << glslang_shader.getInfoDebugLog()          << std::endl ;
-      exit( -1 ) ;
+      log << "GLSL Parsing Failed for: " << stage_name << std::endl ;
+      log << glslang_shader.getInfoLog()               << std::endl ;
+      log << glslang_shader.getInfoDebugLog()          << std::endl ;
+      compilation.log = log.str() ;
+      return ;
     }
 
+    compilation.dependencies = includer.included ;
+
     program.addShader( &glslang_shader ) ;
     if( !program.link( messages        ) )
     {
-      std::cout << "GLSL Program Linking Failed for: " << stage_name << std::endl ;
-      std::cout << program.getInfoLog()                       << std::endl ;
-      std::cout << program.getInfoDebugLog()                  << std::endl ;
-      exit( -1 ) ;
+      log << "GLSL Program Linking Failed for: " << stage_name << std::endl ;
+      log << program.getInfoLog()                       << std::endl ;
+      log << program.getInfoDebugLog()                  << std::endl ;
+      compilation.log = log.str() ;
+      return ;
     }
     
-    glslang::GlslangToSpv( *program.getIntermediate( lang_type ), shader.spirv, &logger, &options ) ;
+    glslang::GlslangToSpv( *program.getIntermediate( lang_type ), compilation.shader.spirv, &logger, &options ) ;
 
     program.buildReflection() ;
-    shader.stage = type ;
-    this->generateDescriptorSetBindings( shader, program ) ;
-    if( type != ShaderStage::Compute ) this->parseAttributes( shader, program ) ;
-    this->map.insert( { type, shader } ) ;
-   }
+    compilation.shader.stage = compilation.stage ;
+    this->generateDescriptorSetBindings( compilation.shader, program ) ;
+    if( compilation.stage != ShaderStage::Compute ) this->parseAttributes( compilation, program ) ;
+    compilation.compiled = true ;
+
+    if( !this->cache_directory.empty() ) this->saveCached( key, compilation ) ;
+  }
+
+  void NyxWriterData::finish()
+  {
+    std::vector<std::thread> workers   ;
+    std::atomic<unsigned>    next( 0 ) ;
+    unsigned                 count     ;
+
+    if( this->pending.empty() ) return ;
+
+    // Every thread, the calling one included, keeps taking the next stage until there are none left.
+    auto work = [ this, &next ]()
+    {
+      for( unsigned index = next++; index < this->pending.size(); index = next++ ) this->compileShader( this->pending[ index ] ) ;
+    };
+
+    count = std::max( 1u, std::min<unsigned>( std::thread::hardware_concurrency(), this->pending.size() ) ) ;
+    for( unsigned index = 1; index < count; index++ ) workers.emplace_back( work ) ;
+
+    work() ;
+    for( auto& worker : workers ) worker.join() ;
+
+    // Stages are added in the order they were given, so the output never depends on which one finished first.
+    for( auto& compilation : this->pending )
+    {
+      if( !compilation.compiled )
+      {
+        std::cout << compilation.log ;
+        exit( -1 ) ;
+      }
+
+      for( const auto& dependency : compilation.dependencies )
+      {
+        if( std::find( this->dependencies.begin(), this->dependencies.end(), dependency ) == this->dependencies.end() ) this->dependencies.push_back( dependency ) ;
+      }
+
+      this->inputs .insert( this->inputs .end(), compilation.inputs .begin(), compilation.inputs .end() ) ;
+      this->outputs.insert( this->outputs.end(), compilation.outputs.begin(), compilation.outputs.end() ) ;
+      if( this->map.insert( { compilation.stage, std::move( compilation.shader ) } ).second && compilation.stage == ShaderStage::Vertex )
+      {
+        this->vertex_attributes = std::move( compilation.vertex_attributes ) ;
+        this->vertex_stride     = compilation.vertex_stride                  ;
+      }
+    }
+
+    this->pending.clear() ;
+  }
   
   NyxWriter::NyxWriter()
   {
@@ -540,101 +1208,177 @@ namespace nyx
     delete this->compiler_data ;
   }
 
-  void NyxWriter::save( const char* path )
+  void NyxWriterData::serialize( Bytes& bytes ) const
   {
-    unsigned  spirv_size     ;
-    unsigned* spirv          ;
-    unsigned  stage          ;
-    unsigned  version        ;
-    unsigned  num_uniforms   ;
-    unsigned  num_inputs     ;
-    unsigned  num_outputs    ;
-    
-    std::string uniform_name    ;
-    unsigned    uniform_type    ;
-    unsigned    uniform_binding ;
-    unsigned    uniform_size    ;
-    
-    std::string input_name      ;
-    std::string input_type      ;
-    unsigned    input_bytesize  ;
-    unsigned    input_location  ;
-    
-    std::string output_name     ;
-    std::string output_type     ;
-    unsigned    output_bytesize ;
-    unsigned    output_location ;
-    
-    std::ofstream stream ;
-
-    stream.open( path, std::ios::binary ) ;
+    std::vector<NyxSection>  sections ;
+    std::vector<Bytes>       payloads ;
+    std::vector<std::string> names    ;
+    StringPool               strings  ;
+    NyxHeader                header   ;
+    unsigned                 offset   ;
+    unsigned                 crc      ;
 
-    num_inputs  = data().inputs .size() ;
-    num_outputs = data().outputs.size() ;
-    
-    version = NYXFILE_VERSION ;
-    
-    if( stream )
     {
-      data().writeMagic   ( stream, MAGIC       ) ;
-      data().writeUnsigned( stream, version     ) ;
-      data().writeUnsigned( stream, size()      ) ;
-      data().writeUnsigned( stream, num_inputs  ) ;
-      data().writeUnsigned( stream, num_outputs ) ;
+      // Pipeline-wide attributes.
+      payloads.emplace_back() ;
+      this->writeUnsigned  ( payloads.back(), this->inputs .size() ) ;
+      this->writeUnsigned  ( payloads.back(), this->outputs.size() ) ;
+      this->writeAttributes( payloads.back(), strings, this->inputs  ) ;
+      this->writeAttributes( payloads.back(), strings, this->outputs ) ;
+      sections.push_back( { SectionType::PipelineSection, 0, 0, 0 } ) ;
+
+      // Name lookup tables of the pipeline-wide attributes.
+      names.clear() ;
+      for( const auto& input : this->inputs ) names.push_back( input.name ) ;
+      payloads.emplace_back() ;
+      this->writeNameTable( payloads.back(), names ) ;
+      sections.push_back( { SectionType::InputHashSection, 0, 0, 0 } ) ;
+
+      names.clear() ;
+      for( const auto& output : this->outputs ) names.push_back( output.name ) ;
+      payloads.emplace_back() ;
+      this->writeNameTable( payloads.back(), names ) ;
+      sections.push_back( { SectionType::OutputHashSection, 0, 0, 0 } ) ;
+
+      for( auto it = this->map.begin(); it != this->map.end(); ++it )
+      {
+        // SPIRV Code, compressed if asked to and if it is well formed enough to be.
+        payloads.emplace_back() ;
+        if( this->compress_spirv && this->writeCompressedSpirv( payloads.back(), it->second.spirv.size(), it->second.spirv.data() ) )
+        {
+          sections.push_back( { SectionType::CompressedSpirvSection, it->second.stage, 0, 0 } ) ;
+        }
+        else
+        {
+          this->writeSpirv( payloads.back(), it->second.spirv.size(), it->second.spirv.data() ) ;
+          sections.push_back( { SectionType::SpirvSection, it->second.stage, 0, 0 } ) ;
+        }
+
+        // Uniforms.
+        payloads.emplace_back() ;
+        this->writeUnsigned( payloads.back(), it->second.uniforms.size() ) ;
+        for( const auto& uniform : it->second.uniforms )
+        {
+          this->writeString  ( payloads.back(), strings, uniform.name ) ; // Uniform Name.
+          this->writeUnsigned( payloads.back(), uniform.type          ) ; // Uniform Type.
+          this->writeUnsigned( payloads.back(), uniform.binding       ) ; // Uniform Binding.
+          this->writeUnsigned( payloads.back(), uniform.size          ) ; // Uniform Size
+        }
+        sections.push_back( { SectionType::ReflectionSection, it->second.stage, 0, 0 } ) ;
+
+        // Name lookup table of the uniforms.
+        names.clear() ;
+        for( const auto& uniform : it->second.uniforms ) names.push_back( uniform.name ) ;
+        payloads.emplace_back() ;
+        this->writeNameTable( payloads.back(), names ) ;
+        sections.push_back( { SectionType::UniformHashSection, it->second.stage, 0, 0 } ) ;
+      }
 
-      for( unsigned index = 0; index < num_inputs; index++ )
+      // Every descriptor binding of the pipeline, ready to create descriptor set layouts from.
+      payloads.emplace_back() ;
+      this->writeBindings( payloads.back() ) ;
+      sections.push_back( { SectionType::BindingSection, 0, 0, 0 } ) ;
+
+      // The vertex input layout, ready to create a pipeline's vertex input state from.
+      payloads.emplace_back() ;
+      this->writeVertexInput( payloads.back() ) ;
+      sections.push_back( { SectionType::VertexInputSection, ShaderStage::Vertex, 0, 0 } ) ;
+
+      // Every name & type referenced above. Readers require the section to hold at least a terminator, even without any names.
+      if( strings.bytes.empty() ) strings.bytes.push_back( '\0' ) ;
+      payloads.push_back( strings.bytes ) ;
+      sections.push_back( { SectionType::StringSection, 0, 0, 0 } ) ;
+
+      // Checksums of every section, filled in once they are all laid out.
+      payloads.emplace_back( ( sections.size() + 1 ) * sizeof( unsigned ), 0 ) ;
+      sections.push_back( { SectionType::ChecksumSection, 0, 0, 0 } ) ;
+
+      // Sections are laid out after the header and the section table, each padded out to the section alignment.
+      offset = sizeof( NyxHeader ) + sections.size() * sizeof( NyxSection ) ;
+      for( unsigned index = 0; index < sections.size(); index++ )
       {
-        input_name     = data().inputs[ index ].name     ;
-        input_type     = data().inputs[ index ].type     ;
-        input_bytesize = data().inputs[ index ].size     ;
-        input_location = data().inputs[ index ].location ;
-
-        data().writeString  ( stream, input_name     ) ;
-        data().writeString  ( stream, input_type     ) ;
-        data().writeUnsigned( stream, input_bytesize ) ;
-        data().writeUnsigned( stream, input_location ) ;
+        sections[ index ].offset = offset                   ;
+        sections[ index ].size   = payloads[ index ].size() ;
+
+        payloads[ index ].resize( ( payloads[ index ].size() + SECTION_ALIGNMENT - 1 ) / SECTION_ALIGNMENT * SECTION_ALIGNMENT, 0 ) ;
+        offset += payloads[ index ].size() ;
       }
-      
-      for( unsigned index = 0; index < num_outputs; index++ )
+
+      for( unsigned index = 0; index + 1 < sections.size(); index++ )
       {
-        output_name     = data().outputs[ index ].name     ;
-        output_type     = data().outputs[ index ].type     ;
-        output_bytesize = data().outputs[ index ].size     ;
-        output_location = data().outputs[ index ].location ;
-
-        data().writeString  ( stream, output_name     ) ;
-        data().writeString  ( stream, output_type     ) ;
-        data().writeUnsigned( stream, output_bytesize ) ;
-        data().writeUnsigned( stream, output_location ) ;
+        crc = crc32c( payloads[ index ].data(), sections[ index ].size ) ;
+        memcpy( payloads.back().data() + index * sizeof( unsigned ), &crc, sizeof( unsigned ) ) ;
       }
 
-      for( auto it = data().map.begin(); it != data().map.end(); ++it )
+      header.magic        = MAGIC                                         ;
+      header.version      = NYXFILE_VERSION                               ;
+      header.flags        = AlignedSections | PooledStrings | Checksummed ;
+      header.num_shaders  = this->map.size()                              ;
+      header.num_sections = sections.size()                               ;
+      header.file_size    = offset                                        ;
+      header.reserved     = 0                                             ;
+
+      crc = tableChecksum( header, sections.data(), sections.size() ) ;
+      memcpy( payloads.back().data() + ( sections.size() - 1 ) * sizeof( unsigned ), &crc, sizeof( unsigned ) ) ;
+
+      // Everything is put together in a single buffer, so the file can be written all at once.
+      bytes.clear() ;
+      bytes.reserve( offset ) ;
+      bytes.insert( bytes.end(), reinterpret_cast<const unsigned char*>( &header ), reinterpret_cast<const unsigned char*>( &header + 1 ) ) ;
+      bytes.insert( bytes.end(), reinterpret_cast<const unsigned char*>( sections.data() ), reinterpret_cast<const unsigned char*>( sections.data() + sections.size() ) ) ;
+      for( const auto& payload : payloads )
       {
-        spirv_size     = it->second.spirv.size()      ;
-        spirv          = it->second.spirv.data()      ;
-        stage          = it->second.stage             ;
-        num_uniforms   = it->second.uniforms.size()   ;
+        bytes.insert( bytes.end(), payload.begin(), payload.end() ) ;
+      }
+    }
+  }
+
+  const unsigned char* NyxWriter::saveToBytes( unsigned& size )
+  {
+    data().finish() ;
+    data().serialize( data().saved ) ;
 
-        data().writeUnsigned( stream, spirv_size        ) ; // Size of SPIRV code.
-        data().writeSpirv   ( stream, spirv_size, spirv ) ; // SPIRV Code.
-        data().writeUnsigned( stream, stage        ) ; // Shader stage.
-        data().writeUnsigned( stream, num_uniforms ) ; // Number of Uniforms.
+    size = data().saved.size() ;
+    return data().saved.data() ;
+  }
 
-        for( unsigned index = 0; index < num_uniforms; index++ )
-        {
-          uniform_name    = it->second.uniforms[ index ].name    ;
-          uniform_size    = it->second.uniforms[ index ].size    ;
-          uniform_type    = it->second.uniforms[ index ].type    ;
-          uniform_binding = it->second.uniforms[ index ].binding ;
-          
-          data().writeString  ( stream, uniform_name    ) ; // Uniform Name.
-          data().writeUnsigned( stream, uniform_type    ) ; // Uniform Type.
-          data().writeUnsigned( stream, uniform_binding ) ; // Uniform Binding.
-          data().writeUnsigned( stream, uniform_size    ) ; // Uniform Size
-        }
+  void NyxWriter::extract( NyxFile& file )
+  {
+    NyxFileBuilder builder ;
+
+    data().finish() ;
+    builder.setBindings   ( data().mergeBindings()                                ) ;
+    builder.setVertexInput( std::move( data().vertex_attributes ), data().vertex_stride ) ;
+
+    for( auto& input  : data().inputs  ) builder.addInput ( std::move( input .name ), std::move( input .type ), input .size, input .location ) ;
+    for( auto& output : data().outputs ) builder.addOutput( std::move( output.name ), std::move( output.type ), output.size, output.location ) ;
+
+    for( auto& shader : data().map )
+    {
+      builder.addStage( shader.second.stage, std::move( shader.second.spirv ) ) ;
+      for( auto& uniform : shader.second.uniforms )
+      {
+        builder.addUniform( shader.second.stage, std::move( uniform.name ), uniform.type, uniform.binding, uniform.size ) ;
       }
     }
-    else
+
+    builder.build( file ) ;
+
+    // Everything compiled now belongs to the file, so this object starts over.
+    data().map              .clear() ;
+    data().inputs           .clear() ;
+    data().outputs          .clear() ;
+    data().vertex_attributes.clear() ;
+    data().dependencies     .clear() ;
+    data().vertex_stride = 0 ;
+  }
+
+  void NyxWriter::save( const char* path )
+  {
+    unsigned size ;
+
+    this->saveToBytes( size ) ;
+    if( !writeAtomically( path, data().saved.data(), data().saved.size() ) )
     {
     #if defined ( __unix__ ) || defined( _WIN32 )
       constexpr const char* COLOR_END    = "\x1B[m"     ;
@@ -658,6 +1402,16 @@ namespace nyx
   {
     data().optimize_size = flag ;
   }
+  void NyxWriter::setCompressSpirv( bool flag )
+  {
+    data().compress_spirv = flag ;
+  }
+
+  void NyxWriter::setCacheDirectory( const char* cache_directory )
+  {
+    data().cache_directory = cache_directory ? cache_directory : "" ;
+  }
+
   void NyxWriter::setIncludeDirectory( const char* include_directory )
   {
     data().include_directory = include_directory ;
@@ -668,9 +1422,26 @@ namespace nyx
     return data().map.size() ;
   }
 
+  unsigned NyxWriter::numDependencies() const
+  {
+    return data().dependencies.size() ;
+  }
+
+  const char* NyxWriter::dependency( unsigned index ) const
+  {
+    return index < data().dependencies.size() ? data().dependencies[ index ].c_str() : "" ;
+  }
+
   void NyxWriter::compile( ShaderStage stage, const char* shader_data )
   {
-    this->data().loadShader                                         ( shader_data, stage ) ;
+    data().pending.emplace_back() ;
+    data().pending.back().stage  = stage       ;
+    data().pending.back().source = shader_data ;
+  }
+
+  void NyxWriter::finish()
+  {
+    data().finish() ;
   }
 
   NyxWriterData& NyxWriter::data()
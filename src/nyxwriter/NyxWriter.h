@@ -25,8 +25,10 @@ namespace nyx
    */
   enum ShaderStage : unsigned ;
   enum UniformType : unsigned ;
+  class NyxFile ;
   
   /** Class to manage writing & reading NyxFile's to disk.
+   * Any amount of writers can be used at once, as long as each one is only used by one thread at a time.
    */
   class NyxWriter
   {
@@ -40,29 +42,72 @@ namespace nyx
        */
       ~NyxWriter() ;
 
-      /** Method to compile the shader with the specific stage and data.
+      /** Method to queue the shader with the specific stage and data to be compiled.
+       * The data is copied, and the shader is compiled by the next call to finish() or save().
        * @param stage The stage to use for the input shader data.
        * @param data The bytes of a valid GLSL file.
        */
       void compile( ShaderStage stage, const char* data ) ;
 
-      /** Method to save the compiled shaders to disk.
+      /** Method to compile every queued shader, each stage on a thread of its own.
+       * The result is the same as compiling them one after another in the order they were queued.
+       */
+      void finish() ;
+
+      /** Method to save the compiled shaders to disk. Finishes compiling any queued shaders first.
+       * The file is written in one go to a temporary file, then moved over the path, so it is never seen half written.
        * @param path The path on the filesystem to save the .kg data to.
        */
       void save( const char* path ) ;
 
+      /** Method to save the compiled shaders to memory, as the bytes save() would write. Finishes compiling any queued shaders first.
+       * @param size Reference to the unsigned integer to store the amount of bytes in.
+       * @return Pointer to the bytes of the .nyx file. Owned by this object, and valid until the next save or its destruction.
+       */
+      const unsigned char* saveToBytes( unsigned& size ) ;
+
+      /** Method to hand the compiled shaders straight to a NyxFile, without saving & loading them back. Finishes compiling any queued shaders first.
+       * The SPIRV & reflection are moved into the file rather than copied, so this object is left without any compiled shaders.
+       * @param file The file to replace the contents of with the compiled shaders.
+       */
+      void extract( NyxFile& file ) ;
+
+      /** Method to set the directory to cache compiled shaders in.
+       * Shaders whose preprocessed GLSL was already compiled with the same settings are then read from the cache instead
+       * of being compiled again. The directory is created when needed, & can be shared by any amount of processes.
+       * @param cache_dir The string of the cache directory on the filesystem, or an empty string to not use a cache.
+       */
+      void setCacheDirectory( const char* cache_dir ) ;
+
       /** Method to set the include directory for the GLSL files to use.
        * @param include_dir The string of the include directory on the filesystem
        */
       void setIncludeDirectory( const char* include_dir ) ;
 
       /** Method to retrieve the size of this object.
-       * @return The number of shaders compiled into this object.
+       * @return The number of shaders compiled into this object, not counting ones queued since the last finish().
        */
       unsigned size() const ;
+
+      /** Method to retrieve the amount of files included by the compiled shaders, not counting ones queued since the last finish().
+       * @return The number of distinct files the compiled shaders included.
+       */
+      unsigned numDependencies() const ;
+
+      /** Method to retrieve the path of a file included by the compiled shaders.
+       * @param index The index of the file, in the order it was first included.
+       * @return The C-string path of the file as it was found, or an empty string if the index is out of range.
+       */
+      const char* dependency( unsigned index ) const ;
       
       void setBuildDebug( bool flag ) ;
       void setOptimizeSize( bool flag ) ;
+
+      /** Method to set whether the SPIRV of saved files is compressed.
+       * Compressed SPIRV is decoded by NyxFile when it is used, and takes a fraction of the space.
+       * @param flag Whether or not to compress the SPIRV of every shader stage when saving.
+       */
+      void setCompressSpirv( bool flag ) ;
     private:
 
         /** Forward declared structure containing this object's data.